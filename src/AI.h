@@ -1,7 +1,8 @@
 #pragma once
 
 // Input board is a flat 9-length char array with values: ' ', 'X', 'O'
-// Returns index 0..8 for best move for 'O' (AI). Returns -1 if no moves left.
+// Returns index 0..8 for best move for 'O' (AI), from the solved table (TicTacToeOracle.h).
+// Returns -1 if the game is over or it is not O's turn (X moves first).
 int AI_FindBestMove(const char board[9]);
 
 
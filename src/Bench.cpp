@@ -0,0 +1,1500 @@
+#include "Bench.h"
+#include "AI.h"
+#include "Chess.h"
+#include "ChessMateSolver.h"
+#include "ChessPgn.h"
+#include "ChessPerft.h"
+#include "ChessReview.h"
+#include "ChessTables.h"
+#include "ChessTT.h"
+#include "ConnectFour.h"
+#include "ConnectFourBook.h"
+#include "CpuTopology.h"
+#include "TicTacToeOracle.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Hardware branch-miss counter for the calling thread (Linux perf events; reports -1 elsewhere
+// or when the kernel does not allow it)
+class BranchMissCounter {
+public:
+    BranchMissCounter() {
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+    ~BranchMissCounter() {
+#if defined(__linux__)
+        if (fd >= 0) close(fd);
+#endif
+    }
+    void start() {
+#if defined(__linux__)
+        if (fd >= 0) { ioctl(fd, PERF_EVENT_IOC_RESET, 0); ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); }
+#endif
+    }
+    long long stop() {
+        long long value = -1;
+#if defined(__linux__)
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &value, sizeof(value)) != sizeof(value)) value = -1;
+        }
+#endif
+        return value;
+    }
+
+private:
+    int fd = -1;
+};
+
+// Fixed positions shared by the move generation benchmarks (some of them in check)
+static const char* kPositionCorpus[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3",
+    "4k3/8/8/8/1b6/8/3P4/4K2R w K - 0 1",
+    "r1bqkb1r/pppp1Qpp/2n2n2/4p3/2B1P3/8/PPPP1PPP/RNB1K1NR b KQkq - 0 4",
+    "8/8/3k4/8/2N1R3/8/8/3K4 b - - 0 1",
+};
+
+// Chess engine internals reached by the benchmarks
+struct ChessBench {
+    // The move generator as it was before the side/type specialization (runtime color and piece
+    // branches, bounds checks on every step), kept as the baseline for --bench movegen. The only
+    // addition is the promotion expansion, so both generators produce the same moves.
+    struct LegacyMoveGenerator {
+        const ChessGame& g;
+
+        bool valid(int row, int col) const { return row >= 0 && row < 8 && col >= 0 && col < 8; }
+
+        void add(int row, int col, int newRow, int newCol, std::vector<Move>& moves) const {
+            Move m(row, col, newRow, newCol);
+            if (g.board[row][col].type != PieceType::PAWN || (newRow != 0 && newRow != 7)) { moves.push_back(m); return; }
+            for (PieceType promo : { PieceType::QUEEN, PieceType::KNIGHT, PieceType::ROOK, PieceType::BISHOP }) {
+                m.promotion = promo;
+                m.isPromotion = true;
+                moves.push_back(m);
+            }
+        }
+
+        void pawn(int row, int col, std::vector<Move>& moves) const {
+            PieceColor color = g.board[row][col].color;
+            bool isWhite = (color == PieceColor::WHITE);
+            int direction = isWhite ? -1 : 1;
+            int startRow = isWhite ? 6 : 1;
+            int newRow = row + direction;
+            if (valid(newRow, col) && g.board[newRow][col].isEmpty()) {
+                add(row, col, newRow, col, moves);
+                if (row == startRow && valid(newRow + direction, col) && g.board[newRow + direction][col].isEmpty()) {
+                    add(row, col, newRow + direction, col, moves);
+                }
+            }
+            for (int offset : { -1, 1 }) {
+                int newCol = col + offset;
+                if (!valid(newRow, newCol)) continue;
+                if (!g.board[newRow][newCol].isEmpty() && g.board[newRow][newCol].color != color) add(row, col, newRow, newCol, moves);
+                if (g.enPassantRow == newRow && g.enPassantCol == newCol) {
+                    Move epMove(row, col, newRow, newCol);
+                    epMove.isEnPassant = true;
+                    moves.push_back(epMove);
+                }
+            }
+        }
+
+        void slider(int row, int col, const int (*directions)[2], int count, std::vector<Move>& moves) const {
+            PieceColor color = g.board[row][col].color;
+            for (int d = 0; d < count; ++d) {
+                for (int i = 1; i < 8; ++i) {
+                    int newRow = row + directions[d][0] * i, newCol = col + directions[d][1] * i;
+                    if (!valid(newRow, newCol)) break;
+                    if (g.board[newRow][newCol].isEmpty()) { add(row, col, newRow, newCol, moves); continue; }
+                    if (g.board[newRow][newCol].color != color) add(row, col, newRow, newCol, moves);
+                    break;
+                }
+            }
+        }
+
+        void stepper(int row, int col, const int (*steps)[2], std::vector<Move>& moves) const {
+            PieceColor color = g.board[row][col].color;
+            for (int i = 0; i < 8; ++i) {
+                int newRow = row + steps[i][0], newCol = col + steps[i][1];
+                if (valid(newRow, newCol) && (g.board[newRow][newCol].isEmpty() || g.board[newRow][newCol].color != color)) {
+                    add(row, col, newRow, newCol, moves);
+                }
+            }
+        }
+
+        void castling(int row, int col, std::vector<Move>& moves) const {
+            PieceColor color = g.board[row][col].color;
+            bool white = color == PieceColor::WHITE;
+            int home = white ? 7 : 0;
+            bool kingMoved = white ? g.whiteKingMoved : g.blackKingMoved;
+            if (kingMoved || row != home || col != 4) return;
+            auto rookAt = [&](int c) { return g.board[home][c].type == PieceType::ROOK && g.board[home][c].color == color; };
+            if (!(white ? g.whiteRookRightMoved : g.blackRookRightMoved) && g.board[home][5].isEmpty() && g.board[home][6].isEmpty() && rookAt(7)) {
+                Move m(home, 4, home, 6);
+                m.isCastling = true;
+                moves.push_back(m);
+            }
+            if (!(white ? g.whiteRookLeftMoved : g.blackRookLeftMoved) && g.board[home][1].isEmpty() && g.board[home][2].isEmpty()
+                && g.board[home][3].isEmpty() && rookAt(0)) {
+                Move m(home, 4, home, 2);
+                m.isCastling = true;
+                moves.push_back(m);
+            }
+        }
+
+        void generate(PieceColor color, std::vector<Move>& moves) const {
+            static const int rook[4][2] = { {-1,0}, {1,0}, {0,-1}, {0,1} };
+            static const int bishop[4][2] = { {-1,-1}, {-1,1}, {1,-1}, {1,1} };
+            static const int knight[8][2] = { {-2,-1}, {-2,1}, {-1,-2}, {-1,2}, {1,-2}, {1,2}, {2,-1}, {2,1} };
+            static const int king[8][2] = { {-1,-1}, {-1,0}, {-1,1}, {0,-1}, {0,1}, {1,-1}, {1,0}, {1,1} };
+            moves.clear();
+            for (int r = 0; r < 8; ++r) {
+                for (int c = 0; c < 8; ++c) {
+                    if (g.board[r][c].isEmpty() || g.board[r][c].color != color) continue;
+                    switch (g.board[r][c].type) {
+                    case PieceType::PAWN: pawn(r, c, moves); break;
+                    case PieceType::ROOK: slider(r, c, rook, 4, moves); break;
+                    case PieceType::BISHOP: slider(r, c, bishop, 4, moves); break;
+                    case PieceType::QUEEN: slider(r, c, rook, 4, moves); slider(r, c, bishop, 4, moves); break;
+                    case PieceType::KNIGHT: stepper(r, c, knight, moves); break;
+                    case PieceType::KING: stepper(r, c, king, moves); castling(r, c, moves); break;
+                    default: break;
+                    }
+                }
+            }
+        }
+    };
+
+    // The pre-specialization generator (LegacyMoveGenerator) vs. the side-specialized
+    // instantiations, with the same moves required of both
+    static int moveGeneration() {
+        const int iterations = 20000;
+        const GenType types[] = { GenType::ALL, GenType::CAPTURES, GenType::QUIETS, GenType::EVASIONS };
+        const char* typeNames[] = { "all", "captures", "quiets", "evasions" };
+        BranchMissCounter counter;
+        int failures = 0;
+        std::vector<Move> moves;
+        std::vector<Move> other;
+
+        struct Row { double seconds = 0; long long misses = 0; size_t moves = 0; };
+        Row runtimeRow;
+        Row typeRows[4];
+        for (const char* fen : kPositionCorpus) {
+            ChessGame game;
+            if (!game.loadFEN(fen)) { printf("bad FEN: %s\n", fen); ++failures; continue; }
+            PieceColor side = game.sideToMove();
+
+            // Consistency: captures + quiets == all, and legal evasions == legal moves
+            game.generateMoves(side, GenType::ALL, moves);
+            size_t all = moves.size();
+            game.validateMoves(moves, side);
+            game.generateMoves(side, GenType::CAPTURES, other);
+            size_t split = other.size();
+            game.generateMoves(side, GenType::QUIETS, other);
+            split += other.size();
+            game.generateMoves(side, GenType::EVASIONS, other);
+            game.validateMoves(other, side);
+            if (split != all || other.size() != moves.size()) { printf("generator mismatch: %s\n", fen); ++failures; }
+            LegacyMoveGenerator legacy{ game };
+            game.generateMoves(side, GenType::ALL, moves);
+            legacy.generate(side, other);
+            auto byPacked = [](const Move& a, const Move& b) { return packMove(a) < packMove(b); };
+            std::sort(moves.begin(), moves.end(), byPacked);
+            std::sort(other.begin(), other.end(), byPacked);
+            if (!std::equal(moves.begin(), moves.end(), other.begin(), other.end(),
+                [](const Move& a, const Move& b) { return packMove(a) == packMove(b); })) {
+                printf("legacy generator mismatch: %s\n", fen);
+                ++failures;
+            }
+
+            // Baseline: color and piece type branched on for every piece and step
+            counter.start();
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) legacy.generate(side, moves);
+            runtimeRow.seconds += secondsSince(t0);
+            runtimeRow.misses += counter.stop();
+            runtimeRow.moves += moves.size() * iterations;
+
+            for (int t = 0; t < 4; ++t) {
+                counter.start();
+                t0 = std::chrono::steady_clock::now();
+                for (int i = 0; i < iterations; ++i) game.generateMoves(side, types[t], moves);
+                typeRows[t].seconds += secondsSince(t0);
+                typeRows[t].misses += counter.stop();
+                typeRows[t].moves += moves.size() * iterations;
+            }
+        }
+
+        int calls = iterations * (int)(sizeof(kPositionCorpus) / sizeof(kPositionCorpus[0]));
+        auto print = [&](const char* name, const Row& row) {
+            printf("%-22s %10.1f ns/call %12.2f misses/call %8.1f moves/call\n", name, row.seconds * 1e9 / calls,
+                row.misses < 0 ? -1.0 : (double)row.misses / calls, (double)row.moves / calls);
+        };
+        print("legacy all", runtimeRow);
+        for (int t = 0; t < 4; ++t) print((std::string("specialized ") + typeNames[t]).c_str(), typeRows[t]);
+        if (runtimeRow.misses < 0) printf("(branch-miss counter unavailable on this system)\n");
+        return failures ? 1 : 0;
+    }
+
+    // Incremental attack maps: consistency against a from-scratch rebuild over random games, then
+    // check tests and make/unmake costs with table reads vs. recomputation
+    static int attackMaps() {
+        int failures = 0;
+        std::mt19937 rng(777);
+        std::vector<Move> moves;
+        for (const char* fen : kPositionCorpus) {
+            ChessGame game;
+            game.loadFEN(fen);
+            PieceColor side = game.sideToMove();
+            for (int ply = 0; ply < 200; ++ply) {
+                game.generatePseudoLegalMoves(side, moves);
+                game.validateMoves(moves, side);
+                if (moves.empty()) break;
+                game.applyMove(moves[rng() % moves.size()]);
+                side = (side == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+                ChessGame rebuilt = game;
+                rebuilt.computeAttackMaps();
+                if (rebuilt.attackCount != game.attackCount || rebuilt.controlledSquares != game.controlledSquares || rebuilt.kingSquare != game.kingSquare) {
+                    printf("attack map mismatch after %d plies from %s\n", ply + 1, fen);
+                    ++failures;
+                    break;
+                }
+            }
+        }
+
+        // The pre-attack-map check test: generate every enemy piece's moves and look for the king square
+        auto checkByMoveLists = [](const ChessGame& g, PieceColor color) {
+            int kr, kc;
+            if (!g.findKing(color, kr, kc)) return false;
+            std::vector<Move> pieceMoves;
+            for (int r = 0; r < ChessGame::BOARD_SIZE; ++r)
+                for (int c = 0; c < ChessGame::BOARD_SIZE; ++c) {
+                    if (g.board[r][c].isEmpty() || g.board[r][c].color == color) continue;
+                    pieceMoves.clear();
+                    g.generateMovesForPiece(r, c, pieceMoves);
+                    for (const auto& m : pieceMoves) if (m.toRow == kr && m.toCol == kc) return true;
+                }
+            return false;
+        };
+        auto checkByRays = [](const ChessGame& g, PieceColor color) {
+            int kr, kc;
+            if (!g.findKing(color, kr, kc)) return false;
+            return color == PieceColor::WHITE ? g.attackersTo<PieceColor::BLACK>(kr, kc, nullptr, 0) > 0 : g.attackersTo<PieceColor::WHITE>(kr, kc, nullptr, 0) > 0;
+        };
+
+        const int iterations = 20000;
+        double tLists = 0, tRays = 0, tTable = 0, tRebuild = 0, tIncremental = 0;
+        long long calls = 0, makes = 0;
+        volatile int sink = 0;
+        for (const char* fen : kPositionCorpus) {
+            ChessGame game;
+            game.loadFEN(fen);
+            PieceColor side = game.sideToMove();
+            for (PieceColor c : { PieceColor::WHITE, PieceColor::BLACK }) {
+                if (checkByMoveLists(game, c) != game.isInCheck(c) || checkByRays(game, c) != game.isInCheck(c)) {
+                    printf("check test mismatch: %s\n", fen);
+                    ++failures;
+                }
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations / 10; ++i) sink += checkByMoveLists(game, side);
+            tLists += secondsSince(t0) * 10;
+            t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) sink += checkByRays(game, side);
+            tRays += secondsSince(t0);
+            t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) sink += game.isInCheck(side);
+            tTable += secondsSince(t0);
+            calls += iterations;
+
+            // Make/unmake every legal move, maintaining the maps incrementally vs. rebuilding them
+            game.generatePseudoLegalMoves(side, moves);
+            game.validateMoves(moves, side);
+            ChessGame::SavedState saved = game.saveState();
+            t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations / 20; ++i)
+                for (const auto& m : moves) { game.applyMove(m); sink += game.isInCheck(side); game.restoreState(saved); }
+            tIncremental += secondsSince(t0);
+            t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations / 20; ++i)
+                for (const auto& m : moves) { game.applyMove(m); game.computeAttackMaps(); sink += game.isInCheck(side); game.restoreState(saved); }
+            tRebuild += secondsSince(t0);
+            makes += (long long)moves.size() * (iterations / 20);
+        }
+        printf("check test   move lists %8.1f ns   ray scan %6.1f ns   attack map %6.1f ns\n",
+            tLists * 1e9 / calls, tRays * 1e9 / calls, tTable * 1e9 / calls);
+        printf("make+unmake  incremental %7.1f ns   full rebuild %6.1f ns\n", tIncremental * 1e9 / makes, tRebuild * 1e9 / makes);
+        return failures ? 1 : 0;
+    }
+
+    // Writes random legal games as a PGN archive, imports it at 1 and N threads, and checks the
+    // database replays the exact moves that were written
+    static int pgnImport(int gameCount) {
+        const char* pgnPath = "bench_games.pgn";
+        const char* dbPath = "bench_games.db";
+        std::mt19937 rng(12345);
+        std::vector<std::vector<uint16_t>> expected;
+        std::string pgn;
+        std::vector<Move> moves;
+        const char* results[] = { "1-0", "0-1", "1/2-1/2", "*" };
+        for (int g = 0; g < gameCount; ++g) {
+            ChessGame game;
+            game.reset();
+            PieceColor side = PieceColor::WHITE;
+            std::vector<uint16_t> line;
+            pgn += "[Event \"Bench\"]\n[Site \"?\"]\n[Round \"" + std::to_string(g + 1) + "\"]\n[Result \"*\"]\n\n";
+            int plies = 20 + (int)(rng() % 100);
+            for (int ply = 0; ply < plies; ++ply) {
+                game.generatePseudoLegalMoves(side, moves);
+                game.validateMoves(moves, side);
+                if (moves.empty()) break;
+                const Move& m = moves[rng() % moves.size()];
+                if (side == PieceColor::WHITE) pgn += std::to_string(ply / 2 + 1) + ". ";
+                pgn += PgnImporter::toSAN(game, side, m);
+                pgn += (ply % 10 == 9) ? "\n" : " ";
+                if (ply == 6) pgn += "{book move} (1. d4 d5) ";
+                line.push_back(packMove(m));
+                game.applyMove(m);
+                side = (side == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+            }
+            pgn += std::string(results[g % 4]) + "\n\n";
+            expected.push_back(line);
+        }
+        FILE* f = fopen(pgnPath, "wb");
+        if (!f) { printf("cannot write %s\n", pgnPath); return 1; }
+        fwrite(pgn.data(), 1, pgn.size(), f);
+        fclose(f);
+
+        int failures = 0;
+        int maxThreads = std::max(1, (int)std::thread::hardware_concurrency());
+        for (int threads : { 1, maxThreads }) {
+            PgnImporter importer(threads);
+            PgnImportStats stats;
+            if (!importer.import(pgnPath, dbPath, stats)) { printf("import failed\n"); ++failures; continue; }
+            GameDatabase db;
+            bool same = db.open(dbPath) && db.size() == expected.size();
+            for (size_t id = 0; same && id < db.size(); ++id) {
+                GameDatabase::Game game = db.game(id);
+                same = game.plies == expected[id].size() && std::equal(expected[id].begin(), expected[id].end(), game.moves)
+                    && game.result == (GameResult)((id % 4 == 3) ? 0 : id % 4 + 1);
+            }
+            if (!same) ++failures;
+            printf("%2d thread(s): %6llu games %8llu plies %8.2f MB  %7.3fs  %9.0f games/s  %s\n", threads,
+                (unsigned long long)stats.games, (unsigned long long)stats.plies, pgn.size() / 1048576.0, stats.seconds,
+                stats.seconds > 0 ? stats.games / stats.seconds : 0.0, same ? "ok" : "MISMATCH");
+            if (maxThreads == 1) break;
+        }
+        std::remove(pgnPath);
+        std::remove(dbPath);
+        return failures ? 1 : 0;
+    }
+
+    // Process start to the first engine move. Everything before main is loader work plus static
+    // initializers; the engine tables are constexpr, so they contribute none of it.
+    static int startup() {
+        double beforeMain = (double)clock() / CLOCKS_PER_SEC;
+        auto t0 = std::chrono::steady_clock::now();
+        ChessGame game;
+        game.init(800, 720);
+        double init = secondsSince(t0);
+        Move quick = game.searchBestMove(PieceColor::WHITE, 1);
+        double first = secondsSince(t0);
+        Move hard = game.searchBestMove(PieceColor::WHITE, 4);
+        double full = secondsSince(t0);
+
+        printf("process CPU before bench   %8.3f ms\n", beforeMain * 1000.0);
+        printf("ChessGame init             %8.3f ms\n", init * 1000.0);
+        printf("first move, depth 1        %8.3f ms  %s\n", first * 1000.0, moveToString(quick).c_str());
+        printf("first move, depth 4 (HARD) %8.3f ms  %s\n", full * 1000.0, moveToString(hard).c_str());
+        printf("read-only tables: geometry %zu bytes, Zobrist %zu bytes\n", sizeof(ChessTables::kTables), sizeof(Zobrist::keys));
+        return quick.fromRow >= 0 && hard.fromRow >= 0 ? 0 : 1;
+    }
+
+    // The Opera game (Morphy, 1858), played into a fresh game with its own cold table
+    static bool operaGame(ChessGame& game) {
+        static const char* opera[] = { "e4", "e5", "Nf3", "d6", "d4", "Bg4", "dxe5", "Bxf3", "Qxf3", "dxe5", "Bc4", "Nf6",
+            "Qb3", "Qe7", "Nc3", "c6", "Bg5", "b5", "Nxb5", "cxb5", "Bxb5+", "Nbd7", "O-O-O", "Rd8", "Rxd7", "Rxd7",
+            "Rd1", "Qe6", "Bxd7+", "Nxd7", "Qb8+", "Nxb8", "Rd8#" };
+        game.init(800, 720);
+        for (const char* san : opera) {
+            Move move(-1, -1, -1, -1);
+            if (!PgnImporter::parseSAN(game, game.currentPlayer, san, move)) { printf("bad move %s\n", san); return false; }
+            game.makeMove(move);
+        }
+        return true;
+    }
+
+    static void reviewOpera(GameReviewer& reviewer, bool interleave) {
+        ChessGame game;
+        if (!operaGame(game)) return;
+        game.tt = std::make_shared<TranspositionTable>(32, interleave);
+        reviewer.start(game);
+        reviewer.wait();
+    }
+
+    static uint64_t reviewNodes(const GameReviewer& reviewer) {
+        uint64_t nodes = 0;
+        for (const ReviewedMove& m : reviewer.moves()) nodes += m.nodes;
+        return nodes;
+    }
+
+    // Post-game review of a short master game at 1, 2, 4, ... threads, each with a cold table
+    static int gameReview(int maxThreads) {
+        if (maxThreads < 1) maxThreads = std::max(1, (int)std::thread::hardware_concurrency());
+        double serial = 0.0;
+        int failures = 0;
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            ReviewOptions options;
+            options.threads = threads;
+            GameReviewer reviewer(options);
+            reviewOpera(reviewer, false);
+            if (threads == 1) {
+                serial = reviewer.seconds();
+                printf("%s\n", GameReviewer::report(reviewer.moves()).c_str());
+            }
+            // Node counts vary with thread timing, since the positions share one table
+            printf("%2d thread(s): %3d positions %10llu nodes %7.2fs  speedup %.2fx\n", threads, reviewer.total(),
+                (unsigned long long)reviewNodes(reviewer), reviewer.seconds(), reviewer.seconds() > 0 ? serial / reviewer.seconds() : 0.0);
+            if (reviewer.total() != 33) ++failures;
+        }
+        return failures ? 1 : 0;
+    }
+
+    // Review and perft scaling with free-floating threads vs. pinned one-per-core threads and a
+    // node-interleaved table
+    static int numaScaling(int maxThreads) {
+        const CpuTopology& topology = CpuTopology::system();
+        ThreadPlacement pinned;
+        pinned.pin = true;
+        if (maxThreads < 1) maxThreads = topology.threadsFor(pinned);
+        printf("topology: %s\n", topology.describe().c_str());
+        std::vector<int> cpus = topology.placement(maxThreads, pinned.skipSMT);
+        printf("placement:");
+        for (int cpu : cpus) printf(" %d(n%d)", cpu, topology.nodeOf(cpu));
+        printf("\n\n            review (33 positions)         perft kiwipete d4\n");
+        printf("threads     free   placed  speedup      free   placed  speedup\n");
+
+        double reviewBase = 0.0, perftBase = 0.0;
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            double review[2], perft[2];
+            for (int placed = 0; placed < 2; ++placed) {
+                ReviewOptions options;
+                options.threads = threads;
+                options.placement.pin = placed != 0;
+                GameReviewer reviewer(options);
+                reviewOpera(reviewer, placed != 0);
+                review[placed] = reviewer.seconds();
+
+                PerftOptions perftOptions;
+                perftOptions.threads = threads;
+                perftOptions.placement.pin = placed != 0;
+                ChessGame game;
+                game.loadFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+                auto t0 = std::chrono::steady_clock::now();
+                ChessPerft(perftOptions).run(game, 4);
+                perft[placed] = secondsSince(t0);
+            }
+            if (threads == 1) { reviewBase = review[0]; perftBase = perft[0]; }
+            printf("%4d     %7.2fs %7.2fs  %4.2f/%4.2fx %7.2fs %7.2fs  %4.2f/%4.2fx\n", threads,
+                review[0], review[1], reviewBase / review[0], reviewBase / review[1],
+                perft[0], perft[1], perftBase / perft[0], perftBase / perft[1]);
+        }
+        return 0;
+    }
+};
+
+// Connect Four positions as the columns played so far, 1-7 from the left; Red moved first and
+// Yellow (the AI) is to move
+static const char* kConnectFourCorpus[] = {
+    "4",
+    "3",
+    "445",
+    "44444",
+    "4443332",
+    "444333222",
+    "43452117666",
+    "444433335652616",
+    "1234567123456776543",
+};
+
+// Connect Four engine internals reached by the benchmarks
+struct ConnectFourBench {
+    static bool setUp(ConnectFourBoard& pos, const std::string& moves) {
+        pos = ConnectFourBoard{};
+        for (char m : moves) {
+            int col = m - '1';
+            if (col < 0 || col >= ConnectFourBoard::COLS || !pos.canPlay(col) || pos.lastMoveWon()) return false;
+            pos.play(col);
+        }
+        return true;
+    }
+    static bool setUp(ConnectFourGame& game, const char* moves) { return setUp(game.position, moves); }
+
+    // Raw search speed: the alpha-beta search on the corpus at each difficulty's fixed depth
+    // (without its time budget), without the transposition table (repeated runs would only
+    // measure table hits)
+    static int search() {
+        printf("%-22s %-6s %4s %12s %10s %12s\n", "position", "level", "col", "nodes", "ms", "nodes/s");
+        int failures = 0;
+        for (GameDifficulty level : { GameDifficulty::MEDIUM, GameDifficulty::HARD }) {
+            uint64_t totalNodes = 0;
+            double totalSeconds = 0;
+            for (const char* moves : kConnectFourCorpus) {
+                ConnectFourGame game;
+                game.setDifficulty(level);
+                if (!setUp(game, moves)) { printf("%-22s bad position\n", moves); ++failures; continue; }
+                // Repeat short searches so the timer has something to measure
+                int col = -1, runs = 0;
+                auto t0 = std::chrono::steady_clock::now();
+                do {
+                    col = game.bestColumn(game.getSearchDepth());
+                    ++runs;
+                } while (secondsSince(t0) < 0.05);
+                double seconds = secondsSince(t0) / runs;
+                uint64_t nodes = game.searchNodes / runs;
+                totalNodes += nodes;
+                totalSeconds += seconds;
+                printf("%-22s %-6s %4d %12llu %10.3f %12.0f\n", *moves ? moves : "(start)", level == GameDifficulty::HARD ? "hard" : "medium",
+                    col + 1, (unsigned long long)nodes, seconds * 1000.0, nodes / seconds);
+            }
+            printf("%-22s %-6s %4s %12llu %10.3f %12.0f\n\n", "total", level == GameDifficulty::HARD ? "hard" : "medium", "",
+                (unsigned long long)totalNodes, totalSeconds * 1000.0, totalNodes / totalSeconds);
+        }
+        return failures ? 1 : 0;
+    }
+
+    // Transposition table at each difficulty's depth: every position searched with a cold table
+    // and with none; the chosen columns must agree
+    static int transpositions() {
+        printf("%-6s %5s | %10s %10s %7s | %10s %10s %7s | %9s %9s\n", "level", "depth", "plain", "table", "saved",
+            "probes", "hits", "hit%", "plain ms", "table ms");
+        int failures = 0;
+        const char* names[] = { "easy", "medium", "hard" };
+        for (GameDifficulty level : { GameDifficulty::EASY, GameDifficulty::MEDIUM, GameDifficulty::HARD }) {
+            uint64_t plainNodes = 0, tableNodes = 0, probes = 0, hits = 0;
+            double plainSeconds = 0, tableSeconds = 0;
+            int depth = 0;
+            for (const char* moves : kConnectFourCorpus) {
+                ConnectFourGame game;
+                game.init(800, 720);
+                game.setDifficulty(level);
+                depth = game.getSearchDepth();
+                if (!setUp(game, moves)) { ++failures; continue; }
+
+                std::shared_ptr<ConnectFourTT> table = game.table;
+                game.table.reset();
+                auto t0 = std::chrono::steady_clock::now();
+                int plainCol = game.bestColumn(depth);
+                plainSeconds += secondsSince(t0);
+                plainNodes += game.searchNodes;
+
+                game.table = table;
+                game.searchNodes = 0;
+                t0 = std::chrono::steady_clock::now();
+                int tableCol = game.bestColumn(depth);
+                tableSeconds += secondsSince(t0);
+                tableNodes += game.searchNodes;
+                probes += game.ttProbes;
+                hits += game.ttHits;
+                if (plainCol != tableCol) { printf("%s: column %d without table, %d with\n", moves, plainCol + 1, tableCol + 1); ++failures; }
+            }
+            printf("%-6s %5d | %10llu %10llu %6.1f%% | %10llu %10llu %6.1f%% | %9.2f %9.2f\n", names[level], depth,
+                (unsigned long long)plainNodes, (unsigned long long)tableNodes, 100.0 * (1.0 - (double)tableNodes / plainNodes),
+                (unsigned long long)probes, (unsigned long long)hits, probes ? 100.0 * hits / probes : 0.0,
+                plainSeconds * 1000.0, tableSeconds * 1000.0);
+        }
+        return failures ? 1 : 0;
+    }
+
+    // Iterative deepening within each difficulty's budget: depth reached and move time on the
+    // corpus, then matches where Yellow searches on the budget against a fixed-depth Red, next to
+    // the same Red against Yellow at the difficulty's old fixed depth. Each opening is two random
+    // stones; both Reds search one ply less, so the fixed-depth Yellow is not simply lost.
+    static int deepening(int openings) {
+        if (openings < 1) openings = 10;
+        const char* names[] = { "easy", "medium", "hard" };
+        printf("%-22s %-6s %4s %6s %10s %12s\n", "position", "level", "col", "depth", "ms", "nodes");
+        for (GameDifficulty level : { GameDifficulty::MEDIUM, GameDifficulty::HARD }) {
+            double worst = 0, budget = 0;
+            for (const char* moves : kConnectFourCorpus) {
+                ConnectFourGame game;
+                game.init(800, 720);
+                game.setDifficulty(level);
+                setUp(game, moves);
+                budget = game.getTimeBudget();
+                auto t0 = std::chrono::steady_clock::now();
+                int col = game.timedColumn(game.getSearchDepth(), game.getTimeBudget());
+                double seconds = secondsSince(t0);
+                worst = std::max(worst, seconds);
+                printf("%-22s %-6s %4d %6d %10.2f %12llu\n", *moves ? moves : "(start)", names[level], col + 1, game.completedDepth,
+                    seconds * 1000.0, (unsigned long long)game.searchNodes);
+            }
+            printf("%-22s %-6s budget %.0f ms, slowest move %.2f ms\n\n", "", names[level], budget * 1000.0, worst * 1000.0);
+        }
+
+        std::mt19937 rng(9);
+        std::vector<std::string> starts;
+        for (int i = 0; i < openings; ++i) starts.push_back(std::string(1, (char)('1' + rng() % 7)) + (char)('1' + rng() % 7));
+        printf("%-6s %8s | %-16s %5s %5s %5s %7s\n", "level", "red", "yellow", "win", "draw", "loss", "score");
+        for (GameDifficulty level : { GameDifficulty::MEDIUM, GameDifficulty::HARD }) {
+            for (int timedYellow = 0; timedYellow < 2; ++timedYellow) {
+                ConnectFourGame yellow, red;
+                yellow.init(800, 720);
+                red.init(800, 720);
+                yellow.setDifficulty(level);
+                int redDepth = yellow.getSearchDepth() - 1;
+                int outcome[3] = {}; // Yellow wins, draws, losses
+                for (const std::string& start : starts) {
+                    ConnectFourBoard pos;
+                    setUp(pos, start);
+                    while (!pos.lastMoveWon() && !pos.full()) {
+                        int col;
+                        if (pos.moves & 1) {
+                            yellow.position = pos;
+                            col = timedYellow ? yellow.timedColumn(yellow.getSearchDepth(), yellow.getTimeBudget())
+                                : yellow.bestColumn(yellow.getSearchDepth());
+                        }
+                        else {
+                            red.position = pos;
+                            col = alphaBetaColumn(red, redDepth);
+                        }
+                        pos.play(col);
+                    }
+                    ++outcome[!pos.lastMoveWon() ? 1 : (pos.moves & 1) ? 2 : 0];
+                }
+                char yellowName[32];
+                snprintf(yellowName, sizeof(yellowName), timedYellow ? "timed, min %d" : "depth %d", yellow.getSearchDepth());
+                char redName[32];
+                snprintf(redName, sizeof(redName), "depth %d", redDepth);
+                printf("%-6s %8s | %-16s %5d %5d %5d %6.1f%%\n", names[level], redName, yellowName, outcome[0], outcome[1], outcome[2],
+                    100.0 * (outcome[0] + 0.5 * outcome[1]) / openings);
+            }
+        }
+        return 0;
+    }
+
+    // Move ordering: every corpus position searched at each depth with a cold table, once in the
+    // fixed order (table move, then center-out) and once in the dynamic one. Columns can differ,
+    // since dynamic ordering also drops moves that lose at once, beyond the horizon's reach.
+    static int ordering() {
+        printf("%5s | %12s %12s %7s | %9s %9s | %s\n", "depth", "fixed", "dynamic", "saved", "fixed ms", "dyn ms", "columns differ");
+        for (int depth : { 4, 5, 7, 9 }) {
+            uint64_t nodes[2] = {};
+            double seconds[2] = {};
+            int differ = 0;
+            for (const char* moves : kConnectFourCorpus) {
+                int col[2];
+                for (int dynamic = 0; dynamic < 2; ++dynamic) {
+                    ConnectFourGame game;
+                    game.init(800, 720);
+                    game.dynamicOrdering = dynamic == 1;
+                    setUp(game, moves);
+                    auto t0 = std::chrono::steady_clock::now();
+                    col[dynamic] = game.bestColumn(depth);
+                    seconds[dynamic] += secondsSince(t0);
+                    nodes[dynamic] += game.searchNodes;
+                }
+                if (col[0] != col[1]) ++differ;
+            }
+            printf("%5d | %12llu %12llu %6.1f%% | %9.2f %9.2f | %d\n", depth, (unsigned long long)nodes[0], (unsigned long long)nodes[1],
+                100.0 * (1.0 - (double)nodes[1] / nodes[0]), seconds[0] * 1000.0, seconds[1] * 1000.0, differ);
+        }
+        return 0;
+    }
+
+    // Leaf evaluation as the search does it, every child of a set of random positions: the
+    // window counts updated for the one stone against a full scan of the child. Random games are
+    // also played out and taken back stone by stone to check the counts against the scan.
+    static int evaluation() {
+        std::mt19937 rng(11);
+        std::vector<ConnectFourBoard> parents;
+        for (int i = 0; i < 4000; ++i) parents.push_back(randomPosition(rng, 4 + (int)(rng() % 36)));
+
+        int wrong = 0;
+        for (int game = 0; game < 200; ++game) {
+            ConnectFourBoard pos;
+            ConnectFourEval eval;
+            eval.reset(pos);
+            std::vector<uint64_t> played;
+            while (!pos.full() && !pos.lastMoveWon()) {
+                int col = (int)(rng() % ConnectFourBoard::COLS);
+                if (!pos.canPlay(col)) continue;
+                uint64_t move = pos.dropCell(col);
+                eval.add(move, pos.moves & 1);
+                pos.play(move);
+                played.push_back(move);
+                if (eval.score(pos) != ConnectFourEval::scan(pos)) ++wrong;
+            }
+            while (!played.empty()) {
+                uint64_t move = played.back();
+                played.pop_back();
+                pos.current = pos.opponent() ^ move;
+                pos.mask ^= move;
+                --pos.moves;
+                eval.remove(move, pos.moves & 1);
+                if (eval.score(pos) != ConnectFourEval::scan(pos)) ++wrong;
+            }
+        }
+
+        const int rounds = 50;
+        uint64_t leaves = 0;
+        long long sumScan = 0, sumIncremental = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            for (const ConnectFourBoard& pos : parents) {
+                for (int c = 0; c < ConnectFourBoard::COLS; ++c) {
+                    if (!pos.canPlay(c)) continue;
+                    ConnectFourBoard child = pos;
+                    child.play(c);
+                    sumScan += ConnectFourEval::scan(child);
+                    ++leaves;
+                }
+            }
+        }
+        double scanSeconds = secondsSince(t0);
+
+        std::vector<ConnectFourEval> evals(parents.size());
+        for (size_t i = 0; i < parents.size(); ++i) evals[i].reset(parents[i]);
+        t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < parents.size(); ++i) {
+                const ConnectFourBoard& pos = parents[i];
+                ConnectFourEval& eval = evals[i];
+                bool yellow = pos.moves & 1;
+                for (int c = 0; c < ConnectFourBoard::COLS; ++c) {
+                    if (!pos.canPlay(c)) continue;
+                    uint64_t move = pos.dropCell(c);
+                    ConnectFourBoard child = pos;
+                    child.play(move);
+                    eval.add(move, yellow);
+                    sumIncremental += eval.score(child);
+                    eval.remove(move, yellow);
+                }
+            }
+        }
+        double incrementalSeconds = secondsSince(t0);
+        if (sumScan != sumIncremental) ++wrong;
+
+        printf("%llu leaves from %zu positions\n", (unsigned long long)leaves, parents.size());
+        printf("full scan    %8.1f ns/leaf\n", scanSeconds * 1e9 / leaves);
+        printf("incremental  %8.1f ns/leaf (add + score + remove)\n", incrementalSeconds * 1e9 / leaves);
+        printf("check: %s\n", wrong ? "FAIL" : "ok");
+        return wrong ? 1 : 0;
+    }
+
+    // Batched leaf scoring: each kernel's scores and win flags against a full scan of every child
+    // of a set of random positions, its time per leaf next to the incremental update's, then the
+    // corpus searched at a few depths with each kernel; nodes and columns must match the scalar
+    // (incremental) search.
+    static int leafKernels() {
+        using Kernel = ConnectFourLeaves::Kernel;
+        std::vector<Kernel> kernels;
+        for (Kernel k : { Kernel::SCALAR, Kernel::SSE2, Kernel::AVX2 }) {
+            if (ConnectFourLeaves::supported(k)) kernels.push_back(k);
+        }
+        std::mt19937 rng(13);
+        std::vector<ConnectFourBoard> parents;
+        for (int i = 0; i < 4000; ++i) parents.push_back(randomPosition(rng, 4 + (int)(rng() % 36)));
+        std::vector<std::vector<uint64_t>> children(parents.size());
+        uint64_t leaves = 0;
+        for (size_t i = 0; i < parents.size(); ++i) {
+            for (int c = 0; c < ConnectFourBoard::COLS; ++c) {
+                if (parents[i].canPlay(c)) children[i].push_back(parents[i].dropCell(c));
+            }
+            leaves += children[i].size();
+        }
+
+        int wrong = 0;
+        for (Kernel k : kernels) {
+            for (size_t i = 0; i < parents.size(); ++i) {
+                int scores[ConnectFourBoard::COLS];
+                bool won[ConnectFourBoard::COLS];
+                ConnectFourLeaves::evaluate(k, parents[i], children[i].data(), (int)children[i].size(), scores, won);
+                for (size_t m = 0; m < children[i].size(); ++m) {
+                    ConnectFourBoard child = parents[i];
+                    child.play(children[i][m]);
+                    if (won[m] != child.lastMoveWon() || (!won[m] && scores[m] != ConnectFourEval::scan(child))) ++wrong;
+                }
+            }
+        }
+
+        const int rounds = 50;
+        printf("%llu leaves from %zu positions\n", (unsigned long long)leaves, parents.size());
+        std::vector<ConnectFourEval> evals(parents.size());
+        for (size_t i = 0; i < parents.size(); ++i) evals[i].reset(parents[i]);
+        long long sumIncremental = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < parents.size(); ++i) {
+                const ConnectFourBoard& pos = parents[i];
+                bool yellow = pos.moves & 1;
+                for (uint64_t move : children[i]) {
+                    ConnectFourBoard child = pos;
+                    child.play(move);
+                    evals[i].add(move, yellow);
+                    sumIncremental += child.lastMoveWon() ? 1 : evals[i].score(child);
+                    evals[i].remove(move, yellow);
+                }
+            }
+        }
+        printf("%-12s %8.1f ns/leaf (add + win test + score + remove)\n", "incremental", secondsSince(t0) * 1e9 / (rounds * leaves));
+        for (Kernel k : kernels) {
+            long long sum = 0;
+            t0 = std::chrono::steady_clock::now();
+            for (int r = 0; r < rounds; ++r) {
+                for (size_t i = 0; i < parents.size(); ++i) {
+                    int scores[ConnectFourBoard::COLS];
+                    bool won[ConnectFourBoard::COLS];
+                    int n = (int)children[i].size();
+                    ConnectFourLeaves::evaluate(k, parents[i], children[i].data(), n, scores, won);
+                    for (int m = 0; m < n; ++m) sum += won[m] ? 1 : scores[m];
+                }
+            }
+            if (sum != sumIncremental) ++wrong;
+            printf("%-12s %8.1f ns/leaf\n", ConnectFourLeaves::name(k), secondsSince(t0) * 1e9 / (rounds * leaves));
+        }
+        printf("check: %s\n\n", wrong ? "FAIL" : "ok");
+
+        printf("%5s %-8s %12s %9s\n", "depth", "kernel", "nodes", "ms");
+        for (int depth : { 5, 7, 9 }) {
+            std::vector<int> reference;
+            uint64_t referenceNodes = 0;
+            for (Kernel k : kernels) {
+                uint64_t nodes = 0;
+                double seconds = 1e9;
+                std::vector<int> columns;
+                for (int run = 0; run < 3; ++run) { // best of three: the runs are short
+                    double total = 0;
+                    nodes = 0;
+                    columns.clear();
+                    for (const char* moves : kConnectFourCorpus) {
+                        ConnectFourGame game;
+                        game.init(800, 720);
+                        game.leafKernel = k;
+                        setUp(game, moves);
+                        auto t1 = std::chrono::steady_clock::now();
+                        columns.push_back(game.bestColumn(depth));
+                        total += secondsSince(t1);
+                        nodes += game.searchNodes;
+                    }
+                    seconds = std::min(seconds, total);
+                }
+                if (k == Kernel::SCALAR) { reference = columns; referenceNodes = nodes; }
+                else if (columns != reference || nodes != referenceNodes) ++wrong;
+                printf("%5d %-8s %12llu %9.2f\n", depth, ConnectFourLeaves::name(k), (unsigned long long)nodes, seconds * 1000.0);
+            }
+        }
+        printf("check: %s\n", wrong ? "FAIL" : "ok");
+        return wrong ? 1 : 0;
+    }
+
+    // Random unfinished position with `empty` cells left, from random games that avoid wins
+    template <class Board = ConnectFourBoard>
+    static Board randomPosition(std::mt19937& rng, int empty) {
+        for (;;) {
+            Board pos;
+            while (pos.moves < Board::CELLS - empty) {
+                int candidates[Board::COLS], n = 0;
+                for (int c = 0; c < Board::COLS; ++c) {
+                    if (pos.canPlay(c) && !pos.isWinningMove(c)) candidates[n++] = c;
+                }
+                if (n == 0) break;
+                pos.play(candidates[rng() % n]);
+            }
+            if (pos.moves == Board::CELLS - empty) return pos;
+        }
+    }
+
+    // Plain alpha-beta over every move, without a table, for checking the solver on small positions
+    template <class Board = ConnectFourBoard>
+    static int referenceScore(const Board& pos, int alpha, int beta) {
+        const int cells = Board::CELLS;
+        if (pos.full()) return 0;
+        for (int c = 0; c < Board::COLS; ++c) {
+            if (pos.canPlay(c) && pos.isWinningMove(c)) return (cells + 1 - pos.moves) / 2;
+        }
+        int best = -cells;
+        for (int c = 0; c < Board::COLS; ++c) {
+            if (!pos.canPlay(c)) continue;
+            Board child = pos;
+            child.play(c);
+            best = std::max(best, -referenceScore(child, -beta, -alpha));
+            alpha = std::max(alpha, best);
+            if (alpha >= beta) break;
+        }
+        return best;
+    }
+
+    // Exact solver on random positions grouped by empty cells; groups of up to 12 empty cells are
+    // checked against plain alpha-beta, and every best move must keep the solved score
+    static int solver(int count, int maxEmpty) {
+        if (count < 1) count = 20;
+        if (maxEmpty < 4) maxEmpty = 28;
+        printf("%5s %6s | %12s %10s %10s | %5s %5s %5s | %s\n", "empty", "count", "avg nodes", "avg ms", "max ms",
+            "win", "draw", "loss", "check");
+        std::mt19937 rng(42);
+        int failures = 0;
+        for (int empty = 4; empty <= maxEmpty; empty += 4) {
+            uint64_t nodes = 0;
+            double total = 0, worst = 0;
+            int outcome[3] = {}, wrong = 0;
+            for (int i = 0; i < count; ++i) {
+                ConnectFourBoard pos = randomPosition(rng, empty);
+                ConnectFourSolver solver;
+                auto t0 = std::chrono::steady_clock::now();
+                ConnectFourSolution s = solver.bestMove(pos);
+                double seconds = secondsSince(t0);
+                total += seconds;
+                worst = std::max(worst, seconds);
+                nodes += s.nodes;
+                ++outcome[s.score > 0 ? 0 : s.score == 0 ? 1 : 2];
+
+                ConnectFourBoard after = pos;
+                after.play(s.column);
+                int kept = after.lastMoveWon() ? (ConnectFourSolver::CELLS + 1 - pos.moves) / 2 : 0;
+                if (!after.lastMoveWon() && !after.full()) {
+                    int reply = 0;
+                    solver.solve(after, reply);
+                    kept = -reply;
+                }
+                bool ok = s.solved && kept == s.score;
+                if (ok && empty <= 12) ok = referenceScore(pos, -ConnectFourSolver::CELLS, ConnectFourSolver::CELLS) == s.score;
+                if (!ok) ++wrong;
+            }
+            failures += wrong;
+            printf("%5d %6d | %12llu %10.3f %10.3f | %5d %5d %5d | %s\n", empty, count, (unsigned long long)(nodes / count),
+                total * 1000.0 / count, worst * 1000.0, outcome[0], outcome[1], outcome[2],
+                wrong ? "FAIL" : empty <= 12 ? "ok (reference)" : "ok");
+        }
+        return failures ? 1 : 0;
+    }
+
+    // Parallel solver on fixed positions (seeded random games with 30 and 32 empty cells), each
+    // with a cold table, at 1, 2, 4, ... threads; scores and columns must match the serial solve
+    static int parallelSolve(int maxThreads) {
+        if (maxThreads < 1) maxThreads = 8;
+        std::mt19937 rng(3);
+        std::vector<ConnectFourBoard> positions;
+        for (int i = 0; i < 8; ++i) positions.push_back(randomPosition(rng, i < 4 ? 30 : 32));
+        printf("%s\n", CpuTopology::system().describe().c_str());
+        printf("%7s | %12s %10s %12s %8s | %s\n", "threads", "nodes", "ms", "nodes/s", "speedup", "check");
+        std::vector<ConnectFourSolution> serial;
+        double serialSeconds = 0;
+        int failures = 0;
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            uint64_t nodes = 0;
+            double seconds = 0;
+            int wrong = 0;
+            for (size_t i = 0; i < positions.size(); ++i) {
+                ConnectFourSolver solver;
+                solver.setThreads(threads);
+                auto t0 = std::chrono::steady_clock::now();
+                ConnectFourSolution s = solver.bestMove(positions[i]);
+                seconds += secondsSince(t0);
+                nodes += s.nodes;
+                if (threads == 1) serial.push_back(s);
+                else if (s.score != serial[i].score || s.column != serial[i].column) ++wrong;
+                if (!s.solved) ++wrong;
+            }
+            if (threads == 1) serialSeconds = seconds;
+            failures += wrong;
+            printf("%7d | %12llu %10.1f %12.0f %7.2fx | %s\n", threads, (unsigned long long)nodes, seconds * 1000.0,
+                nodes / seconds, serialSeconds / seconds, wrong ? "FAIL" : "ok");
+        }
+        return failures ? 1 : 0;
+    }
+
+    // One board of the size matrix: exact solves of random positions by empty cells, each with
+    // a cold table and a time limit. Positions the side to move wins at once are skipped, they
+    // cost no search. Solves with 8 and 12 empty cells are first checked against plain
+    // alpha-beta; returns the number that disagree.
+    template <class Board>
+    static int boardSize(const char* name, int count, int maxEmpty, double limit) {
+        std::mt19937 rng(42);
+        int wrong = 0, checked = 0;
+        for (int empty = 8; empty <= 12; empty += 4) {
+            for (int i = 0; i < count; ++i, ++checked) {
+                Board pos = randomPosition<Board>(rng, empty);
+                ConnectNSolver<Board> solver;
+                int score = 0;
+                if (!solver.solve(pos, score) || score != referenceScore(pos, -Board::CELLS, Board::CELLS)) ++wrong;
+            }
+        }
+        printf("%-16s %5s %6d | reference check: %s\n", name, "8-12", checked, wrong ? "FAIL" : "ok");
+        for (int empty = 20; empty <= maxEmpty; empty += 4) {
+            uint64_t nodes = 0;
+            double total = 0, worst = 0;
+            int unsolved = 0;
+            for (int i = 0; i < count; ++i) {
+                Board pos = randomPosition<Board>(rng, empty);
+                while (pos.canWinNext()) pos = randomPosition<Board>(rng, empty);
+                ConnectNSolver<Board> solver;
+                solver.setTimeLimit(limit);
+                auto t0 = std::chrono::steady_clock::now();
+                ConnectFourSolution s = solver.bestMove(pos);
+                double seconds = secondsSince(t0);
+                total += seconds;
+                worst = std::max(worst, seconds);
+                nodes += s.nodes;
+                if (!s.solved) ++unsolved;
+            }
+            printf("%-16s %5d %6d | %12llu %10.3f %10.3f %12.0f | %d\n", name, empty, count, (unsigned long long)(nodes / count),
+                total * 1000.0 / count, worst * 1000.0, nodes / total, unsolved);
+        }
+        return wrong;
+    }
+
+    // Solver speed across board sizes and win lengths, all instantiated from the same templates
+    static int boardSizes(int count, int maxEmpty) {
+        if (count < 1) count = 10;
+        if (maxEmpty < 20) maxEmpty = 28;
+        const double limit = 10.0;
+        printf("%-16s %5s %6s | %12s %10s %10s %12s | %s\n", "board", "empty", "count", "avg nodes", "avg ms", "max ms",
+            "nodes/s", "unsolved");
+        int wrong = boardSize<ConnectFourBoard>("6x7 connect-4", count, maxEmpty, limit);
+        wrong += boardSize<ConnectFour7x8Board>("7x8 connect-4", count, maxEmpty, limit);
+#if CONNECTN_WIDE_BOARDS
+        wrong += boardSize<ConnectFour8x9Board>("8x9 connect-4", count, maxEmpty, limit);
+        wrong += boardSize<ConnectFive8x9Board>("8x9 connect-5", count, maxEmpty, limit);
+#endif
+        return wrong ? 1 : 0;
+    }
+
+    // The game's alpha-beta for either side: its own move choice for Yellow, and for Red the
+    // same root loop minimizing
+    static int alphaBetaColumn(ConnectFourGame& game, int depth) {
+        if (game.position.moves & 1) return game.bestColumn(depth);
+        game.prepareSearch();
+        game.searchDepth = depth;
+        game.eval.reset(game.position);
+        int bestVal = 10000000, bestCol = -1;
+        for (int c : ConnectFourBoard::CENTER_ORDER) {
+            if (!game.position.canPlay(c)) continue;
+            uint64_t move = game.position.dropCell(c);
+            ConnectFourBoard child = game.position;
+            child.play(move);
+            game.eval.add(move, false);
+            int val = game.minimax(child, 0, -10000000, 10000000, true);
+            game.eval.remove(move, false);
+            if (val < bestVal) { bestVal = val; bestCol = c; }
+        }
+        return bestCol;
+    }
+
+    // Tree search: playouts per second on the corpus by thread count, then matches against the
+    // alpha-beta AI at several depths with the same time per move: the tree search's budget is
+    // alpha-beta's average move time so far (measured on the corpus before the first game), and
+    // both sides' actual times are shown. Each opening (two random stones) is played once with
+    // either color.
+    static int monteCarlo(int openings, int maxThreads) {
+        if (openings < 1) openings = 10;
+        if (maxThreads < 1) maxThreads = CpuTopology::system().threadsFor(ThreadPlacement{});
+        printf("%s\n", CpuTopology::system().describe().c_str());
+        printf("%7s | %12s %12s %10s\n", "threads", "playouts", "playouts/s", "nodes");
+        const double perPosition = 0.25;
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            uint64_t playouts = 0, nodes = 0;
+            double seconds = 0;
+            for (const char* moves : kConnectFourCorpus) {
+                ConnectFourBoard pos;
+                setUp(pos, moves);
+                ConnectFourMCTS mcts;
+                mcts.setThreads(threads);
+                mcts.setTimeLimit(perPosition);
+                auto t0 = std::chrono::steady_clock::now();
+                ConnectFourMCTSResult r = mcts.search(pos);
+                seconds += secondsSince(t0);
+                playouts += r.playouts;
+                nodes += r.nodes;
+            }
+            printf("%7d | %12llu %12.0f %10llu\n", threads, (unsigned long long)playouts, playouts / seconds,
+                (unsigned long long)(nodes / (sizeof(kConnectFourCorpus) / sizeof(kConnectFourCorpus[0]))));
+        }
+
+        std::mt19937 rng(5);
+        std::vector<std::string> starts;
+        for (int i = 0; i < openings; ++i) starts.push_back(std::string(1, (char)('1' + rng() % 7)) + (char)('1' + rng() % 7));
+        printf("\n%-5s %5s | %9s %9s | %5s %5s %5s %7s | %10s %12s\n", "mcts", "depth", "ab ms", "mcts ms",
+            "win", "draw", "loss", "score", "playouts/s", "kept nodes");
+        for (MCTSPolicy policy : { MCTSPolicy::UCT, MCTSPolicy::PUCT }) {
+            for (int depth : { 4, 6, 8 }) {
+                // Alpha-beta's move time at this depth, on the corpus with a warm table
+                ConnectFourGame game;
+                game.init(800, 720);
+                int calibrated = 0;
+                auto t0 = std::chrono::steady_clock::now();
+                for (const char* moves : kConnectFourCorpus) {
+                    setUp(game, moves);
+                    alphaBetaColumn(game, depth);
+                    ++calibrated;
+                }
+                double calibration = secondsSince(t0) / calibrated;
+
+                int outcome[3] = {}; // MCTS wins, draws, losses
+                double abSeconds = 0, mctsSeconds = 0;
+                int abMoves = 0, mctsMoves = 0;
+                uint64_t playouts = 0, kept = 0;
+                for (int g = 0; g < 2 * openings; ++g) {
+                    bool mctsRed = g % 2 == 0;
+                    ConnectFourMCTS mcts;
+                    mcts.setPolicy(policy);
+                    mcts.setThreads(maxThreads);
+                    mcts.setSeed(g + 1);
+                    setUp(game.position, starts[g / 2]);
+                    while (!game.position.lastMoveWon() && !game.position.full()) {
+                        bool redToMove = !(game.position.moves & 1);
+                        int col;
+                        auto t1 = std::chrono::steady_clock::now();
+                        if (redToMove == mctsRed) {
+                            mcts.setTimeLimit(abMoves ? abSeconds / abMoves : calibration);
+                            ConnectFourMCTSResult r = mcts.search(game.position);
+                            col = r.column;
+                            mctsSeconds += secondsSince(t1);
+                            playouts += r.playouts;
+                            kept += r.reused;
+                            ++mctsMoves;
+                        }
+                        else {
+                            col = alphaBetaColumn(game, depth);
+                            abSeconds += secondsSince(t1);
+                            ++abMoves;
+                        }
+                        game.position.play(col);
+                    }
+                    if (!game.position.lastMoveWon()) ++outcome[1];
+                    else {
+                        bool redWon = game.position.moves & 1;
+                        ++outcome[redWon == mctsRed ? 0 : 2];
+                    }
+                }
+                int games = 2 * openings;
+                printf("%-5s %5d | %9.2f %9.2f | %5d %5d %5d %6.1f%% | %10.0f %12llu\n", policy == MCTSPolicy::UCT ? "uct" : "puct",
+                    depth, abSeconds * 1000.0 / abMoves, mctsSeconds * 1000.0 / mctsMoves, outcome[0], outcome[1], outcome[2],
+                    100.0 * (outcome[0] + 0.5 * outcome[1]) / games, mctsSeconds > 0 ? playouts / mctsSeconds : 0.0,
+                    (unsigned long long)(kept / mctsMoves));
+            }
+        }
+        return 0;
+    }
+
+    // Opening book under a fixed 10-move line (a full book from the empty board takes days of
+    // CPU): generation time and size, book scores against a bookless solver along random lines,
+    // and HARD's move time on those lines with and without the book
+    static int openingBook(int plies, int threads) {
+        const char* path = "bench_c4.book";
+        ConnectFourBookOptions options;
+        options.root = "4356435621";
+        options.ply = 10 + (plies > 0 ? plies : 4);
+        options.threads = threads;
+        auto t0 = std::chrono::steady_clock::now();
+        if (!ConnectFourBook::generate(path, options)) { printf("generation failed\n"); return 1; }
+        double generation = secondsSince(t0);
+        ConnectFourBook book;
+        if (!book.open(path)) { printf("cannot open %s\n", path); return 1; }
+        printf("book: %zu positions, ply %d, %zu bytes, generated in %.2fs\n", book.size(), book.ply(),
+            book.size() * sizeof(uint64_t), generation);
+
+        std::mt19937 rng(7);
+        int checked = 0, wrong = 0, moves = 0;
+        double withBook = 0, withoutBook = 0, worstWith = 0, worstWithout = 0;
+        ConnectFourSolver booked, plain;
+        booked.setBook(&book);
+        for (int line = 0; line < 20; ++line) {
+            ConnectFourBoard pos;
+            setUp(pos, options.root);
+            while (pos.moves <= book.ply() && !pos.canWinNext()) {
+                int bookScore = 0, solved = 0;
+                ConnectFourSolver reference;
+                if (!book.probe(pos, bookScore) || !reference.solve(pos, solved) || bookScore != solved) ++wrong;
+                ++checked;
+
+                auto t1 = std::chrono::steady_clock::now();
+                ConnectFourSolution a = booked.bestMove(pos);
+                double s = secondsSince(t1);
+                withBook += s;
+                worstWith = std::max(worstWith, s);
+                t1 = std::chrono::steady_clock::now();
+                ConnectFourSolution b = plain.bestMove(pos);
+                s = secondsSince(t1);
+                withoutBook += s;
+                worstWithout = std::max(worstWithout, s);
+                if (a.score != b.score) ++wrong;
+                ++moves;
+
+                int cols[ConnectFourBoard::COLS], n = 0;
+                for (int c = 0; c < ConnectFourBoard::COLS; ++c) if (pos.canPlay(c) && !pos.isWinningMove(c)) cols[n++] = c;
+                if (n == 0) break;
+                pos.play(cols[rng() % n]);
+            }
+        }
+        std::remove(path);
+        printf("checked %d book scores against the solver: %s\n", checked, wrong ? "FAIL" : "ok");
+        printf("HARD move time over %d positions: with book avg %.3f ms (max %.3f), without avg %.3f ms (max %.3f)\n",
+            moves, withBook * 1000.0 / moves, worstWith * 1000.0, withoutBook * 1000.0 / moves, worstWithout * 1000.0);
+        return wrong ? 1 : 0;
+    }
+};
+
+struct MatePosition {
+    const char* fen;
+    int mateIn;
+};
+
+// Forced mates for the side to move
+static const MatePosition kMateSuite[] = {
+    { "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", 1 },
+    { "r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5Q2/PPPP1PPP/RNB1K1NR w KQkq - 0 1", 1 },
+    { "kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1", 2 },
+    { "r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 0", 2 },
+    { "6k1/pp4p1/2p5/2bp4/8/P5Pb/1P3rrP/2BRRN1K b - - 0 1", 2 },
+    { "r5rk/5p1p/5R2/4B3/8/8/7P/7K w - - 0 1", 3 },
+    { "2r3k1/p4p2/3Rp2p/1p2P1pK/8/1P4P1/P3Q2P/1q6 b - - 0 1", 3 },
+};
+
+// Proof-number mate solver vs. plain minimax at the matching depth on the same positions
+static int benchMate() {
+    printf("%-4s %-6s | %12s %10s | %12s %10s | %s\n", "#", "mate", "pn nodes", "pn ms", "mm nodes", "mm ms", "result");
+    int failures = 0;
+    int index = 0;
+    for (const auto& p : kMateSuite) {
+        ++index;
+        ChessGame game;
+        game.init(800, 720);
+        if (!game.loadFEN(p.fen)) { printf("%-4d bad FEN\n", index); ++failures; continue; }
+        PieceColor side = game.sideToMove();
+
+        MateSolver solver(16);
+        auto t0 = std::chrono::steady_clock::now();
+        MateResult mate = solver.findMate(game, side, p.mateIn);
+        double pnMs = secondsSince(t0) * 1000.0;
+
+        game.resetNodeCount();
+        int score = 0;
+        t0 = std::chrono::steady_clock::now();
+        // minimax only sees the mate once the mated side's empty move list is inside the horizon
+        game.searchBestMove(side, p.mateIn * 2, &score);
+        double mmMs = secondsSince(t0) * 1000.0;
+        bool mmMate = std::abs(score) > 900000;
+
+        bool ok = mate.found && mate.mateIn == p.mateIn && mmMate;
+        if (!ok) ++failures;
+        printf("%-4d %-6d | %12llu %10.1f | %12llu %10.1f | %s %s\n", index, p.mateIn,
+            (unsigned long long)mate.nodes, pnMs, (unsigned long long)game.nodeCount(), mmMs,
+            ok ? "ok" : "FAIL", mate.line.empty() ? "" : moveToString(mate.line[0]).c_str());
+    }
+    return failures ? 1 : 0;
+}
+
+// Recognized endings the search must still play correctly: the side to move and a move that
+// loses at once, which no depth may choose
+struct EndgameCheck {
+    const char* fen;
+    const char* blunder;
+};
+
+static const EndgameCheck kEndgameChecks[] = {
+    { "1k6/8/NK6/3N4/8/8/8/8 b - - 0 1", "b8a8" }, // KNNvK: Ka8 allows Nc7#, so it is not a draw
+};
+
+static int benchEndgames() {
+    int failures = 0;
+    for (const EndgameCheck& c : kEndgameChecks) {
+        for (int depth = 1; depth <= 5; ++depth) {
+            ChessGame game;
+            game.init(800, 720);
+            if (!game.loadFEN(c.fen)) { printf("bad FEN %s\n", c.fen); ++failures; break; }
+            int score = 0;
+            Move best = game.searchBestMove(game.sideToMove(), depth, &score);
+            bool ok = moveToString(best) != c.blunder;
+            if (!ok) ++failures;
+            printf("%-34s depth %d  %-6s %8s  %s\n", c.fen, depth, moveToString(best).c_str(), formatScore(score).c_str(), ok ? "ok" : "FAIL");
+        }
+    }
+    return failures ? 1 : 0;
+}
+
+// Early-game think time with a cold table vs. a table warmed from the previous run's cache file
+static int benchTTCache() {
+    const char* path = "bench_search.cache";
+    const char* openings[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1",
+        "rnbqkbnr/pppp1ppp/8/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R b KQkq - 1 2",
+        "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    };
+    const int depth = 4;
+    std::remove(path);
+
+    auto run = [&](bool warm, uint64_t& nodes) {
+        ChessGame game;
+        game.init(800, 720);
+        bool loaded = warm && game.loadSearchCache(path);
+        if (warm && !loaded) printf("cache file missing or rejected\n");
+        double seconds = 0;
+        for (const char* fen : openings) {
+            game.loadFEN(fen);
+            auto t0 = std::chrono::steady_clock::now();
+            game.searchBestMove(game.sideToMove(), depth);
+            seconds += secondsSince(t0);
+        }
+        nodes = game.nodeCount();
+        if (!warm) game.saveSearchCache(path);
+        return seconds;
+    };
+
+    uint64_t coldNodes = 0, warmNodes = 0;
+    double cold = run(false, coldNodes);
+    FILE* f = fopen(path, "rb");
+    long bytes = 0;
+    if (f) { fseek(f, 0, SEEK_END); bytes = ftell(f); fclose(f); }
+    double warm = run(true, warmNodes);
+    std::remove(path);
+
+    printf("cold  %8.1f ms %12llu nodes\n", cold * 1000.0, (unsigned long long)coldNodes);
+    printf("warm  %8.1f ms %12llu nodes   (cache file %ld bytes)\n", warm * 1000.0, (unsigned long long)warmNodes, bytes);
+    return (bytes > 0 && warmNodes < coldNodes) ? 0 : 1;
+}
+
+// Plain alpha-beta over the whole tree, for checking the Tic-Tac-Toe table: scores as the
+// table's, from O's side, `plies` after the position searched
+static int tttReference(char b[9], int plies, bool oToMove, int alpha, int beta) {
+    static const int lines[8][3] = { {0,1,2}, {3,4,5}, {6,7,8}, {0,3,6}, {1,4,7}, {2,5,8}, {0,4,8}, {2,4,6} };
+    for (const auto& l : lines) {
+        if (b[l[0]] != ' ' && b[l[0]] == b[l[1]] && b[l[1]] == b[l[2]]) return b[l[0]] == 'O' ? 10 - plies : -10 + plies;
+    }
+    int best = oToMove ? -1000 : 1000;
+    bool moved = false;
+    for (int i = 0; i < 9; ++i) {
+        if (b[i] != ' ') continue;
+        moved = true;
+        b[i] = oToMove ? 'O' : 'X';
+        int v = tttReference(b, plies + 1, !oToMove, alpha, beta);
+        b[i] = ' ';
+        if (oToMove) { best = std::max(best, v); alpha = std::max(alpha, best); }
+        else { best = std::min(best, v); beta = std::min(beta, best); }
+        if (beta <= alpha) break;
+    }
+    return moved ? best : 0;
+}
+
+// Best move as the game's search picked it: each move with a full window, lowest cell among equals
+static int tttSearchMove(char b[9], bool oToMove) {
+    int bestMove = -1, bestValue = oToMove ? -1000 : 1000;
+    for (int i = 0; i < 9; ++i) {
+        if (b[i] != ' ') continue;
+        b[i] = oToMove ? 'O' : 'X';
+        int v = tttReference(b, 0, !oToMove, -10000, 10000);
+        b[i] = ' ';
+        if (oToMove ? v > bestValue : v < bestValue) { bestValue = v; bestMove = i; }
+    }
+    return bestMove;
+}
+
+// Tic-Tac-Toe table against the full search: every reachable position's value and best move,
+// then the time per move of the search, AI_FindBestMove, and the batch lookup, over the
+// positions where O is to move
+static int benchTicTacToe() {
+    std::vector<char> boards; // O to move, 9 cells each
+    int wrong = 0, positions = 0;
+    for (int code = 0; code < TicTacToeOracle::STATES; ++code) {
+        const TicTacToeOracle::Entry& e = TicTacToeOracle::lookup(code);
+        if (!e.reachable) continue;
+        ++positions;
+        char b[9];
+        int stones = 0;
+        for (int i = 0, rest = code; i < 9; ++i, rest /= 3) { b[i] = " XO"[rest % 3]; stones += b[i] != ' '; }
+        bool oToMove = stones & 1;
+        if (tttReference(b, 0, oToMove, -10000, 10000) != e.value) ++wrong;
+        bool over = e.value == 10 || e.value == -10 || stones == 9;
+        if ((over ? -1 : tttSearchMove(b, oToMove)) != e.move) ++wrong;
+        if (!over && oToMove) boards.insert(boards.end(), b, b + 9);
+    }
+    int n = (int)boards.size() / 9;
+
+    long long sumSearch = 0, sumLookup = 0, sumBatch = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < n; ++k) sumSearch += tttSearchMove(&boards[9 * k], true);
+    double searchSeconds = secondsSince(t0);
+    const int rounds = 1000;
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (int k = 0; k < n; ++k) sumLookup += AI_FindBestMove(&boards[9 * k]);
+    }
+    double lookupSeconds = secondsSince(t0);
+    std::vector<int> moves(n);
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        TicTacToeOracle::bestMoves(boards.data(), n, moves.data());
+        for (int m : moves) sumBatch += m;
+    }
+    double batchSeconds = secondsSince(t0);
+    if (sumLookup != sumSearch * rounds || sumBatch != sumLookup || positions != TicTacToeOracle::reachableCount()) ++wrong;
+
+    printf("%d reachable positions, %d symmetry classes, table %zu bytes\n", positions, TicTacToeOracle::classCount(),
+        sizeof(TicTacToeOracle::Entry) * TicTacToeOracle::STATES);
+    printf("%d positions with O to move\n", n);
+    printf("search          %10.1f ns/move\n", searchSeconds * 1e9 / n);
+    printf("AI_FindBestMove %10.1f ns/move\n", lookupSeconds * 1e9 / ((double)rounds * n));
+    printf("bestMoves       %10.1f ns/move\n", batchSeconds * 1e9 / ((double)rounds * n));
+    printf("check: %s\n", wrong ? "FAIL" : "ok");
+    return wrong ? 1 : 0;
+}
+
+int RunBenchmarks(int argc, char** argv) {
+    const char* name = (argc > 0) ? argv[0] : "";
+    if (strcmp(name, "mate") == 0) return benchMate();
+    if (strcmp(name, "movegen") == 0) return ChessBench::moveGeneration();
+    if (strcmp(name, "endgames") == 0) return benchEndgames();
+    if (strcmp(name, "ttcache") == 0) return benchTTCache();
+    if (strcmp(name, "attacks") == 0) return ChessBench::attackMaps();
+    if (strcmp(name, "pgn") == 0) return ChessBench::pgnImport(argc > 1 ? atoi(argv[1]) : 2000);
+    if (strcmp(name, "startup") == 0) return ChessBench::startup();
+    if (strcmp(name, "numa") == 0) return ChessBench::numaScaling(argc > 1 ? atoi(argv[1]) : 0);
+    if (strcmp(name, "c4search") == 0) return ConnectFourBench::search();
+    if (strcmp(name, "c4tt") == 0) return ConnectFourBench::transpositions();
+    if (strcmp(name, "c4deepen") == 0) return ConnectFourBench::deepening(argc > 1 ? atoi(argv[1]) : 0);
+    if (strcmp(name, "c4order") == 0) return ConnectFourBench::ordering();
+    if (strcmp(name, "c4eval") == 0) return ConnectFourBench::evaluation();
+    if (strcmp(name, "c4leaves") == 0) return ConnectFourBench::leafKernels();
+    if (strcmp(name, "c4book") == 0) return ConnectFourBench::openingBook(argc > 1 ? atoi(argv[1]) : 0, argc > 2 ? atoi(argv[2]) : 0);
+    if (strcmp(name, "c4sizes") == 0) return ConnectFourBench::boardSizes(argc > 1 ? atoi(argv[1]) : 0, argc > 2 ? atoi(argv[2]) : 0);
+    if (strcmp(name, "c4mcts") == 0) return ConnectFourBench::monteCarlo(argc > 1 ? atoi(argv[1]) : 0, argc > 2 ? atoi(argv[2]) : 0);
+    if (strcmp(name, "c4parallel") == 0) return ConnectFourBench::parallelSolve(argc > 1 ? atoi(argv[1]) : 0);
+    if (strcmp(name, "c4solve") == 0) return ConnectFourBench::solver(argc > 1 ? atoi(argv[1]) : 0, argc > 2 ? atoi(argv[2]) : 0);
+    if (strcmp(name, "ttt") == 0) return benchTicTacToe();
+    if (strcmp(name, "review") == 0) return ChessBench::gameReview(argc > 1 ? atoi(argv[1]) : 0);
+    printf("usage: --bench <mate|endgames|movegen|ttcache|attacks|pgn [games]|review [threads]|startup|numa [threads]|c4search|c4tt|c4order|c4deepen [openings]|c4eval|c4leaves|c4solve [count] [max empty]|c4parallel [threads]|c4sizes [count] [max empty]|c4mcts [openings] [threads]|c4book [plies] [threads]|ttt>\n");
+    return 2;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Console benchmarks, run as: <exe> --bench <name> [args]
+// Returns the process exit code (non-zero if a suite check failed).
+int RunBenchmarks(int argc, char** argv);
@@ -1,12 +1,31 @@
 ﻿#include "Chess.h"
+#include "ChessTT.h"
+#include "ChessAnalysis.h"
+#include "ChessMateSolver.h"
+#include "ChessEndgame.h"
+#include "ChessReview.h"
+#include "ChessTables.h"
+#include "CpuTopology.h"
 #include <algorithm>
 #include <cmath>
 #include <string>
 
+std::string moveToString(const Move& m) {
+    std::string s;
+    s += (char)('a' + m.fromCol); s += (char)('8' - m.fromRow);
+    s += (char)('a' + m.toCol); s += (char)('8' - m.toRow);
+    if (m.isPromotion) {
+        s += (m.promotion == PieceType::KNIGHT) ? 'n' : (m.promotion == PieceType::BISHOP) ? 'b' : (m.promotion == PieceType::ROOK) ? 'r' : 'q';
+    }
+    return s;
+}
+
 void ChessGame::init(int screenWidth, int screenHeight) {
     screenW = screenWidth;
     screenH = screenHeight;
     reset();
+    // Spread the table's pages over the nodes so no single memory controller serves every probe
+    if (!tt) tt = std::make_shared<TranspositionTable>(32, CpuTopology::system().nodeCount() > 1);
     const float margin = 40.0f;
     float size = (float)std::min(screenWidth - margin * 2, screenHeight - margin * 2 - 100);
     cellSize = size / BOARD_SIZE;
@@ -14,17 +33,29 @@ void ChessGame::init(int screenWidth, int screenHeight) {
     boardRect = { (screenWidth - boardSize) * 0.5f, (screenHeight - boardSize) * 0.5f - 20, boardSize, boardSize };
 }
 
+bool ChessGame::loadSearchCache(const std::string& path) {
+    return tt && tt->openDiskCache(path);
+}
+
+bool ChessGame::saveSearchCache(const std::string& path) {
+    return tt && tt->saveDiskCache(path);
+}
+
 void ChessGame::reset() {
     initBoard();
     currentPlayer = PieceColor::WHITE;
     gameOver = false;
     AisCheckmate = false;
     AisStalemate = false;
+    AisInsufficientMaterial = false;
     AisInCheck = false;
     winner = PieceColor::NONE;
+    startFEN.clear();
+    history.clear();
+    reviewRequested = false;
     selectedRow = selectedCol = -1;
     highlightedMoves.clear();
-    legalMoves.clear();
+    ++positionVersion;
 
     whiteKingMoved = false;
     whiteRookLeftMoved = false;
@@ -33,6 +64,7 @@ void ChessGame::reset() {
     blackRookLeftMoved = false;
     blackRookRightMoved = false;
     enPassantRow = enPassantCol = -1;
+    analyzedKey = 0;
 }
 
 void ChessGame::initBoard() {
@@ -72,6 +104,90 @@ void ChessGame::initBoard() {
     for (int i = 0; i < BOARD_SIZE; ++i) {
         board[1][i] = { PieceType::PAWN, PieceColor::BLACK };
     }
+    computeAttackMaps();
+}
+
+bool ChessGame::loadFEN(const std::string& fen) {
+    std::array<std::array<Piece, BOARD_SIZE>, BOARD_SIZE> parsed{};
+    size_t i = 0;
+    int row = 0, col = 0;
+    for (; i < fen.size() && fen[i] != ' '; ++i) {
+        char ch = fen[i];
+        if (ch == '/') { ++row; col = 0; continue; }
+        if (ch >= '1' && ch <= '8') { col += ch - '0'; continue; }
+        PieceColor color = (ch >= 'a' && ch <= 'z') ? PieceColor::BLACK : PieceColor::WHITE;
+        PieceType type;
+        switch (ch | 0x20) {
+        case 'k': type = PieceType::KING; break;
+        case 'q': type = PieceType::QUEEN; break;
+        case 'r': type = PieceType::ROOK; break;
+        case 'b': type = PieceType::BISHOP; break;
+        case 'n': type = PieceType::KNIGHT; break;
+        case 'p': type = PieceType::PAWN; break;
+        default: return false;
+        }
+        if (!isValidSquare(row, col)) return false;
+        parsed[row][col] = Piece{ type, color };
+        ++col;
+    }
+    if (row != BOARD_SIZE - 1) return false;
+
+    auto nextField = [&]() {
+        while (i < fen.size() && fen[i] == ' ') ++i;
+        size_t start = i;
+        while (i < fen.size() && fen[i] != ' ') ++i;
+        return fen.substr(start, i - start);
+    };
+    std::string side = nextField();
+    std::string castling = nextField();
+    std::string ep = nextField();
+
+    reset();
+    startFEN = fen;
+    board = parsed;
+    computeAttackMaps();
+    currentPlayer = (side == "b") ? PieceColor::BLACK : PieceColor::WHITE;
+    whiteKingMoved = castling.find_first_of("KQ") == std::string::npos;
+    whiteRookRightMoved = castling.find('K') == std::string::npos;
+    whiteRookLeftMoved = castling.find('Q') == std::string::npos;
+    blackKingMoved = castling.find_first_of("kq") == std::string::npos;
+    blackRookRightMoved = castling.find('k') == std::string::npos;
+    blackRookLeftMoved = castling.find('q') == std::string::npos;
+    if (ep.size() == 2 && ep[0] >= 'a' && ep[0] <= 'h' && ep[1] >= '1' && ep[1] <= '8') {
+        enPassantCol = ep[0] - 'a';
+        enPassantRow = '8' - ep[1];
+    }
+    ++positionVersion;
+    checkGameState();
+    return true;
+}
+
+std::string ChessGame::toFEN(PieceColor sideToMove) const {
+    std::string fen;
+    for (int r = 0; r < BOARD_SIZE; ++r) {
+        int empty = 0;
+        for (int c = 0; c < BOARD_SIZE; ++c) {
+            const Piece& p = board[r][c];
+            if (p.isEmpty()) { ++empty; continue; }
+            if (empty) { fen += (char)('0' + empty); empty = 0; }
+            const char* letters = " kqrbnp";
+            char ch = letters[(int)p.type];
+            fen += (p.color == PieceColor::WHITE) ? (char)(ch - 'a' + 'A') : ch;
+        }
+        if (empty) fen += (char)('0' + empty);
+        if (r != BOARD_SIZE - 1) fen += '/';
+    }
+    fen += (sideToMove == PieceColor::BLACK) ? " b " : " w ";
+    std::string castling;
+    if (!whiteKingMoved && !whiteRookRightMoved) castling += 'K';
+    if (!whiteKingMoved && !whiteRookLeftMoved) castling += 'Q';
+    if (!blackKingMoved && !blackRookRightMoved) castling += 'k';
+    if (!blackKingMoved && !blackRookLeftMoved) castling += 'q';
+    fen += castling.empty() ? "-" : castling;
+    fen += ' ';
+    if (enPassantCol >= 0) { fen += (char)('a' + enPassantCol); fen += (char)('8' - enPassantRow); }
+    else fen += '-';
+    return fen + " 0 1";
 }
 
 Vector2 ChessGame::squareCenter(int row, int col) const {
@@ -86,57 +202,112 @@ int ChessGame::squareFromMouse(Vector2 m, int& row, int& col) const {
     return 1;
 }
 
+uint64_t ChessGame::computeHash(PieceColor sideToMove) const {
+    uint64_t h = 0;
+    for (int r = 0; r < BOARD_SIZE; ++r) {
+        for (int c = 0; c < BOARD_SIZE; ++c) {
+            const Piece& p = board[r][c];
+            if (p.isEmpty()) continue;
+            h ^= Zobrist::piece[p.color == PieceColor::WHITE ? 0 : 1][(int)p.type - 1][r * 8 + c];
+        }
+    }
+    if (sideToMove == PieceColor::BLACK) h ^= Zobrist::blackToMove;
+    if (!whiteKingMoved && !whiteRookRightMoved) h ^= Zobrist::castling[0];
+    if (!whiteKingMoved && !whiteRookLeftMoved) h ^= Zobrist::castling[1];
+    if (!blackKingMoved && !blackRookRightMoved) h ^= Zobrist::castling[2];
+    if (!blackKingMoved && !blackRookLeftMoved) h ^= Zobrist::castling[3];
+    if (enPassantCol >= 0) h ^= Zobrist::enPassantFile[enPassantCol];
+    return h;
+}
+
 bool ChessGame::isValidSquare(int row, int col) const {
     return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
 }
 
+// Per-color constants for the specialized generators
+template <PieceColor Us>
+struct ColorTraits {
+    static_assert(Us != PieceColor::NONE, "side to move must be White or Black");
+    static constexpr bool isWhite = (Us == PieceColor::WHITE);
+    static constexpr PieceColor them = isWhite ? PieceColor::BLACK : PieceColor::WHITE;
+    static constexpr int direction = isWhite ? -1 : 1;
+    static constexpr int startRow = isWhite ? 6 : 1;
+    static constexpr int backRank = isWhite ? 7 : 0;
+};
+
+// Precomputed geometry (ChessTables.h): rays 0-3 are orthogonal, 4-7 diagonal
+static constexpr const ChessTables::Tables& kGeo = ChessTables::kTables;
+static constexpr int ROOK_DIRS = 0, BISHOP_DIRS = 4, ALL_DIRS = 8;
+
+// Whether a move onto `target` belongs to the requested generation type
+template <GenType Type>
+static inline bool wantsTarget(const Piece& target) {
+    if constexpr (Type == GenType::CAPTURES) return !target.isEmpty();
+    else if constexpr (Type == GenType::QUIETS) return target.isEmpty();
+    else return true;
+}
+
+// Pawn moves onto the last rank expand into all four promotions, queen first so the UI auto-queens
+static inline void addPawnMove(const Move& move, std::vector<Move>& moves) {
+    if (move.toRow != 0 && move.toRow != 7) {
+        moves.push_back(move);
+        return;
+    }
+    for (PieceType promo : { PieceType::QUEEN, PieceType::KNIGHT, PieceType::ROOK, PieceType::BISHOP }) {
+        Move m = move;
+        m.promotion = promo;
+        m.isPromotion = true;
+        moves.push_back(m);
+    }
+}
+
+template <PieceColor Us, GenType Type>
 void ChessGame::generatePawnMoves(int row, int col, std::vector<Move>& moves) const {
-    PieceColor color = board[row][col].color;
-    bool isWhite = (color == PieceColor::WHITE);
-    int direction = isWhite ? -1 : 1;
-    int startRow = isWhite ? 6 : 1;
+    using T = ColorTraits<Us>;
+    int newRow = row + T::direction;
 
     // Forward one square
-    int newRow = row + direction;
-    if (isValidSquare(newRow, col) && board[newRow][col].isEmpty()) {
-        moves.push_back(Move(row, col, newRow, col));
-        // Forward two squares from starting position
-        if (row == startRow && isValidSquare(newRow + direction, col) && board[newRow + direction][col].isEmpty()) {
-            moves.push_back(Move(row, col, newRow + direction, col));
+    if constexpr (Type != GenType::CAPTURES) {
+        if (isValidSquare(newRow, col) && board[newRow][col].isEmpty()) {
+            addPawnMove(Move(row, col, newRow, col), moves);
+            // Forward two squares from starting position
+            if (row == T::startRow && board[newRow + T::direction][col].isEmpty()) {
+                moves.push_back(Move(row, col, newRow + T::direction, col));
+            }
         }
     }
 
     // Capture diagonally
-    for (int offset : {-1, 1}) {
-        int newCol = col + offset;
-        if (isValidSquare(newRow, newCol)) {
-            if (!board[newRow][newCol].isEmpty() && board[newRow][newCol].color != color) {
-                moves.push_back(Move(row, col, newRow, newCol));
-            }
-            // En passant
-            if (enPassantRow == newRow && enPassantCol == newCol) {
-                Move epMove(row, col, newRow, newCol);
-                epMove.isEnPassant = true;
-                moves.push_back(epMove);
+    if constexpr (Type != GenType::QUIETS) {
+        for (int offset : {-1, 1}) {
+            int newCol = col + offset;
+            if (isValidSquare(newRow, newCol)) {
+                if (board[newRow][newCol].color == T::them) {
+                    addPawnMove(Move(row, col, newRow, newCol), moves);
+                }
+                // En passant
+                if (enPassantRow == newRow && enPassantCol == newCol) {
+                    Move epMove(row, col, newRow, newCol);
+                    epMove.isEnPassant = true;
+                    moves.push_back(epMove);
+                }
             }
         }
     }
 }
 
-void ChessGame::generateRookMoves(int row, int col, std::vector<Move>& moves) const {
-    PieceColor color = board[row][col].color;
-    int directions[4][2] = { {-1,0}, {1,0}, {0,-1}, {0,1} };
-
-    for (auto& dir : directions) {
-        for (int i = 1; i < BOARD_SIZE; ++i) {
-            int newRow = row + dir[0] * i;
-            int newCol = col + dir[1] * i;
-            if (!isValidSquare(newRow, newCol)) break;
-            if (board[newRow][newCol].isEmpty()) {
-                moves.push_back(Move(row, col, newRow, newCol));
+template <PieceColor Us, GenType Type, int FirstDir, int LastDir>
+void ChessGame::generateSliderMoves(int row, int col, std::vector<Move>& moves) const {
+    for (int d = FirstDir; d < LastDir; ++d) {
+        const ChessTables::Ray& ray = kGeo.rays[d][row * 8 + col];
+        for (int i = 0; i < ray.length; ++i) {
+            int newRow = ray.squares[i] / 8, newCol = ray.squares[i] % 8;
+            const Piece& target = board[newRow][newCol];
+            if (target.isEmpty()) {
+                if (wantsTarget<Type>(target)) moves.push_back(Move(row, col, newRow, newCol));
             }
             else {
-                if (board[newRow][newCol].color != color) {
+                if (target.color != Us && wantsTarget<Type>(target)) {
                     moves.push_back(Move(row, col, newRow, newCol));
                 }
                 break;
@@ -145,165 +316,274 @@ void ChessGame::generateRookMoves(int row, int col, std::vector<Move>& moves) co
     }
 }
 
-void ChessGame::generateBishopMoves(int row, int col, std::vector<Move>& moves) const {
-    PieceColor color = board[row][col].color;
-    int directions[4][2] = { {-1,-1}, {-1,1}, {1,-1}, {1,1} };
+template <PieceColor Us, GenType Type>
+void ChessGame::generateKnightMoves(int row, int col, std::vector<Move>& moves) const {
+    const ChessTables::SquareList& targets = kGeo.knight[row * 8 + col];
+    for (int i = 0; i < targets.count; ++i) {
+        int newRow = targets.squares[i] / 8, newCol = targets.squares[i] % 8;
+        const Piece& target = board[newRow][newCol];
+        if (target.color != Us && wantsTarget<Type>(target)) {
+            moves.push_back(Move(row, col, newRow, newCol));
+        }
+    }
+}
+
+template <PieceColor Us, GenType Type>
+void ChessGame::generateKingMoves(int row, int col, std::vector<Move>& moves) const {
+    using T = ColorTraits<Us>;
+    const ChessTables::SquareList& targets = kGeo.king[row * 8 + col];
+    for (int i = 0; i < targets.count; ++i) {
+        int newRow = targets.squares[i] / 8, newCol = targets.squares[i] % 8;
+        const Piece& target = board[newRow][newCol];
+        if (target.color != Us && wantsTarget<Type>(target)) {
+            moves.push_back(Move(row, col, newRow, newCol));
+        }
+    }
 
-    for (auto& dir : directions) {
-        for (int i = 1; i < BOARD_SIZE; ++i) {
-            int newRow = row + dir[0] * i;
-            int newCol = col + dir[1] * i;
-            if (!isValidSquare(newRow, newCol)) break;
-            if (board[newRow][newCol].isEmpty()) {
-                moves.push_back(Move(row, col, newRow, newCol));
+    // Castling (quiet, and never an evasion)
+    if constexpr (Type == GenType::ALL || Type == GenType::QUIETS) {
+        constexpr int r = T::backRank;
+        bool kingMoved = T::isWhite ? whiteKingMoved : blackKingMoved;
+        bool rookLeftMoved = T::isWhite ? whiteRookLeftMoved : blackRookLeftMoved;
+        bool rookRightMoved = T::isWhite ? whiteRookRightMoved : blackRookRightMoved;
+        // The king may not castle out of, through or into check
+        auto attacked = [this](int c) { return isAttackedBy(r * 8 + c, T::them); };
+        if (!kingMoved && row == r && col == 4 && !attacked(4)) {
+            // Kingside castling
+            if (!rookRightMoved && board[r][5].isEmpty() && board[r][6].isEmpty() && board[r][7].type == PieceType::ROOK && board[r][7].color == Us
+                && !attacked(5) && !attacked(6)) {
+                Move castlingMove(r, 4, r, 6);
+                castlingMove.isCastling = true;
+                moves.push_back(castlingMove);
             }
-            else {
-                if (board[newRow][newCol].color != color) {
-                    moves.push_back(Move(row, col, newRow, newCol));
-                }
-                break;
+            // Queenside castling
+            if (!rookLeftMoved && board[r][1].isEmpty() && board[r][2].isEmpty() && board[r][3].isEmpty() && board[r][0].type == PieceType::ROOK && board[r][0].color == Us
+                && !attacked(3) && !attacked(2)) {
+                Move castlingMove(r, 4, r, 2);
+                castlingMove.isCastling = true;
+                moves.push_back(castlingMove);
             }
         }
     }
 }
 
-void ChessGame::generateQueenMoves(int row, int col, std::vector<Move>& moves) const {
-    generateRookMoves(row, col, moves);
-    generateBishopMoves(row, col, moves);
+template <PieceColor Us, GenType Type>
+void ChessGame::generatePieceMoves(int row, int col, std::vector<Move>& moves) const {
+    switch (board[row][col].type) {
+    case PieceType::PAWN: generatePawnMoves<Us, Type>(row, col, moves); break;
+    case PieceType::ROOK: generateSliderMoves<Us, Type, ROOK_DIRS, BISHOP_DIRS>(row, col, moves); break;
+    case PieceType::BISHOP: generateSliderMoves<Us, Type, BISHOP_DIRS, ALL_DIRS>(row, col, moves); break;
+    case PieceType::QUEEN: generateSliderMoves<Us, Type, ROOK_DIRS, ALL_DIRS>(row, col, moves); break;
+    case PieceType::KNIGHT: generateKnightMoves<Us, Type>(row, col, moves); break;
+    case PieceType::KING: generateKingMoves<Us, Type>(row, col, moves); break;
+    default: break;
+    }
 }
 
-void ChessGame::generateKnightMoves(int row, int col, std::vector<Move>& moves) const {
-    PieceColor color = board[row][col].color;
-    int moves_knight[8][2] = { {-2,-1}, {-2,1}, {-1,-2}, {-1,2}, {1,-2}, {1,2}, {2,-1}, {2,1} };
-
-    for (auto& m : moves_knight) {
-        int newRow = row + m[0];
-        int newCol = col + m[1];
-        if (isValidSquare(newRow, newCol)) {
-            if (board[newRow][newCol].isEmpty() || board[newRow][newCol].color != color) {
-                moves.push_back(Move(row, col, newRow, newCol));
-            }
+// Squares holding a `Them` piece that attacks (row, col); returns how many were found
+template <PieceColor Them>
+int ChessGame::attackersTo(int row, int col, int* squares, int maxCount) const {
+    int count = 0, square = row * 8 + col;
+    auto found = [&](int sq) { if (count < maxCount) squares[count] = sq; ++count; };
+    auto scan = [&](const ChessTables::SquareList& list, PieceType type) {
+        for (int i = 0; i < list.count; ++i) {
+            const Piece& p = board[list.squares[i] / 8][list.squares[i] % 8];
+            if (p.type == type && p.color == Them) found(list.squares[i]);
+        }
+    };
+    // A Them pawn attacks forward-diagonally, i.e. from where one of our pawns would attack
+    scan(kGeo.pawnAttacks[colorIndex(ColorTraits<Them>::them)][square], PieceType::PAWN);
+    scan(kGeo.knight[square], PieceType::KNIGHT);
+    scan(kGeo.king[square], PieceType::KING);
+    for (int d = 0; d < 8; ++d) {
+        bool diagonal = d >= BISHOP_DIRS;
+        const ChessTables::Ray& ray = kGeo.rays[d][square];
+        for (int i = 0; i < ray.length; ++i) {
+            const Piece& p = board[ray.squares[i] / 8][ray.squares[i] % 8];
+            if (p.isEmpty()) continue;
+            if (p.color == Them && (p.type == PieceType::QUEEN || p.type == (diagonal ? PieceType::BISHOP : PieceType::ROOK))) found(ray.squares[i]);
+            break;
         }
     }
+    return count;
 }
 
-void ChessGame::generateKingMoves(int row, int col, std::vector<Move>& moves) const {
-    PieceColor color = board[row][col].color;
-    int directions[8][2] = { {-1,-1}, {-1,0}, {-1,1}, {0,-1}, {0,1}, {1,-1}, {1,0}, {1,1} };
-
-    for (auto& dir : directions) {
-        int newRow = row + dir[0];
-        int newCol = col + dir[1];
-        if (isValidSquare(newRow, newCol)) {
-            if (board[newRow][newCol].isEmpty() || board[newRow][newCol].color != color) {
-                moves.push_back(Move(row, col, newRow, newCol));
+void ChessGame::bumpAttack(int color, int square, int delta) {
+    uint8_t& n = attackCount[color][square];
+    if (delta > 0) { if (n++ == 0) ++controlledSquares[color]; }
+    else if (--n == 0) --controlledSquares[color];
+}
+
+// Adds (delta = 1) or removes (-1) the attacks of `piece` standing on `square`
+void ChessGame::addAttacks(int square, const Piece& piece, int delta) {
+    int color = colorIndex(piece.color);
+    auto steps = [&](const ChessTables::SquareList& targets) {
+        for (int i = 0; i < targets.count; ++i) bumpAttack(color, targets.squares[i], delta);
+    };
+    switch (piece.type) {
+    case PieceType::PAWN: steps(kGeo.pawnAttacks[color][square]); break;
+    case PieceType::KNIGHT: steps(kGeo.knight[square]); break;
+    case PieceType::KING: steps(kGeo.king[square]); break;
+    case PieceType::BISHOP:
+    case PieceType::ROOK:
+    case PieceType::QUEEN:
+        for (int d = (piece.type == PieceType::BISHOP) ? BISHOP_DIRS : ROOK_DIRS; d < ((piece.type == PieceType::ROOK) ? BISHOP_DIRS : ALL_DIRS); ++d) {
+            const ChessTables::Ray& ray = kGeo.rays[d][square];
+            for (int i = 0; i < ray.length; ++i) {
+                bumpAttack(color, ray.squares[i], delta);
+                if (!board[ray.squares[i] / 8][ray.squares[i] % 8].isEmpty()) break;
             }
         }
+        break;
+    default: break;
     }
+}
 
-    // Castling
-    if (color == PieceColor::WHITE && !whiteKingMoved && row == 7 && col == 4) {
-        // Kingside castling
-        if (!whiteRookRightMoved && board[7][5].isEmpty() && board[7][6].isEmpty() && board[7][7].type == PieceType::ROOK && board[7][7].color == PieceColor::WHITE) {
-            Move castlingMove(7, 4, 7, 6);
-            castlingMove.isCastling = true;
-            moves.push_back(castlingMove);
-        }
-        // Queenside castling
-        if (!whiteRookLeftMoved && board[7][1].isEmpty() && board[7][2].isEmpty() && board[7][3].isEmpty() && board[7][0].type == PieceType::ROOK && board[7][0].color == PieceColor::WHITE) {
-            Move castlingMove(7, 4, 7, 2);
-            castlingMove.isCastling = true;
-            moves.push_back(castlingMove);
-        }
-    }
-    else if (color == PieceColor::BLACK && !blackKingMoved && row == 0 && col == 4) {
-        // Kingside castling
-        if (!blackRookRightMoved && board[0][5].isEmpty() && board[0][6].isEmpty() && board[0][7].type == PieceType::ROOK && board[0][7].color == PieceColor::BLACK) {
-            Move castlingMove(0, 4, 0, 6);
-            castlingMove.isCastling = true;
-            moves.push_back(castlingMove);
-        }
-        // Queenside castling
-        if (!blackRookLeftMoved && board[0][1].isEmpty() && board[0][2].isEmpty() && board[0][3].isEmpty() && board[0][0].type == PieceType::ROOK && board[0][0].color == PieceColor::BLACK) {
-            Move castlingMove(0, 4, 0, 2);
-            castlingMove.isCastling = true;
-            moves.push_back(castlingMove);
+// Sliders whose rays reach `square` gain (delta = 1, square vacated) or lose (-1, square
+// filled) the part of the ray beyond it
+void ChessGame::extendRaysThrough(int square, int delta) {
+    static constexpr int kOpposite[8] = { 1, 0, 3, 2, 7, 6, 5, 4 };
+    for (int d = 0; d < 8; ++d) {
+        const ChessTables::Ray& ray = kGeo.rays[d][square];
+        int i = 0;
+        while (i < ray.length && board[ray.squares[i] / 8][ray.squares[i] % 8].isEmpty()) ++i;
+        if (i == ray.length) continue;
+        const Piece& slider = board[ray.squares[i] / 8][ray.squares[i] % 8];
+        bool diagonal = d >= BISHOP_DIRS;
+        if (slider.type != PieceType::QUEEN && slider.type != (diagonal ? PieceType::BISHOP : PieceType::ROOK)) continue;
+        int color = colorIndex(slider.color);
+        const ChessTables::Ray& beyond = kGeo.rays[kOpposite[d]][square];
+        for (int j = 0; j < beyond.length; ++j) {
+            bumpAttack(color, beyond.squares[j], delta);
+            if (!board[beyond.squares[j] / 8][beyond.squares[j] % 8].isEmpty()) break;
         }
     }
 }
 
-void ChessGame::generateMovesForPiece(int row, int col, std::vector<Move>& moves) const {
-    PieceType type = board[row][col].type;
-    switch (type) {
-    case PieceType::PAWN: generatePawnMoves(row, col, moves); break;
-    case PieceType::ROOK: generateRookMoves(row, col, moves); break;
-    case PieceType::BISHOP: generateBishopMoves(row, col, moves); break;
-    case PieceType::QUEEN: generateQueenMoves(row, col, moves); break;
-    case PieceType::KNIGHT: generateKnightMoves(row, col, moves); break;
-    case PieceType::KING: generateKingMoves(row, col, moves); break;
-    default: break;
-    }
+// The single place applyMove changes a square, so the attack maps never go stale
+void ChessGame::setSquare(int row, int col, Piece piece) {
+    int square = row * 8 + col;
+    Piece old = board[row][col];
+    if (!old.isEmpty()) addAttacks(square, old, -1);
+    if (old.isEmpty() && !piece.isEmpty()) extendRaysThrough(square, -1);
+    board[row][col] = piece;
+    if (!old.isEmpty() && piece.isEmpty()) extendRaysThrough(square, 1);
+    if (!piece.isEmpty()) addAttacks(square, piece, 1);
+
+    if (old.type == PieceType::KING && kingSquare[colorIndex(old.color)] == square) kingSquare[colorIndex(old.color)] = -1;
+    if (piece.type == PieceType::KING) kingSquare[colorIndex(piece.color)] = square;
+    materialKey += materialUnit(piece) - materialUnit(old);
 }
 
-void ChessGame::generatePseudoLegalMoves(PieceColor color, std::vector<Move>& moves) const {
-    moves.clear();
+void ChessGame::computeAttackMaps() {
+    for (auto& counts : attackCount) counts.fill(0);
+    controlledSquares.fill(0);
+    kingSquare.fill(-1);
+    materialKey = 0;
     for (int r = 0; r < BOARD_SIZE; ++r) {
         for (int c = 0; c < BOARD_SIZE; ++c) {
-            if (!board[r][c].isEmpty() && board[r][c].color == color) {
-                generateMovesForPiece(r, c, moves);
-            }
+            const Piece& p = board[r][c];
+            if (p.isEmpty()) continue;
+            addAttacks(r * 8 + c, p, 1);
+            materialKey += materialUnit(p);
+            if (p.type == PieceType::KING) kingSquare[colorIndex(p.color)] = r * 8 + c;
         }
     }
 }
 
-int ChessGame::findKing(PieceColor color, int& row, int& col) const {
+// In check: king steps, plus captures of / interpositions against a single checker
+template <PieceColor Us>
+void ChessGame::generateEvasions(std::vector<Move>& moves) const {
+    int kingRow, kingCol;
+    int checkers[2];
+    int checkCount = findKing(Us, kingRow, kingCol) ? attackersTo<ColorTraits<Us>::them>(kingRow, kingCol, checkers, 2) : 0;
+    if (checkCount == 0) { generateMoves<Us, GenType::ALL>(moves); return; }
+
+    moves.clear();
+    generateKingMoves<Us, GenType::EVASIONS>(kingRow, kingCol, moves);
+    if (checkCount > 1) return; // double check: only the king can move
+
+    int checkRow = checkers[0] / 8, checkCol = checkers[0] % 8;
+    uint64_t targets = 1ULL << checkers[0];
+    PieceType checkerType = board[checkRow][checkCol].type;
+    if (checkerType == PieceType::ROOK || checkerType == PieceType::BISHOP || checkerType == PieceType::QUEEN) {
+        int dr = (kingRow > checkRow) - (kingRow < checkRow);
+        int dc = (kingCol > checkCol) - (kingCol < checkCol);
+        for (int r = checkRow + dr, c = checkCol + dc; r != kingRow || c != kingCol; r += dr, c += dc) targets |= 1ULL << (r * 8 + c);
+    }
+
+    std::vector<Move> pieceMoves;
     for (int r = 0; r < BOARD_SIZE; ++r) {
         for (int c = 0; c < BOARD_SIZE; ++c) {
-            if (board[r][c].type == PieceType::KING && board[r][c].color == color) {
-                row = r; col = c;
-                return 1;
+            if (board[r][c].color != Us || board[r][c].type == PieceType::KING) continue;
+            pieceMoves.clear();
+            generatePieceMoves<Us, GenType::ALL>(r, c, pieceMoves);
+            for (const auto& m : pieceMoves) {
+                // An en passant capture removes the checker from beside the target square
+                int captureSquare = m.isEnPassant ? m.fromRow * 8 + m.toCol : m.toRow * 8 + m.toCol;
+                if (targets & (1ULL << (m.toRow * 8 + m.toCol)) || captureSquare == checkers[0]) moves.push_back(m);
             }
         }
     }
-    return 0;
 }
 
-bool ChessGame::isSquareAttacked(int row, int col, PieceColor attackerColor) const {
-    std::vector<Move> attackerMoves;
-    for (int r = 0; r < BOARD_SIZE; ++r) {
-        for (int c = 0; c < BOARD_SIZE; ++c) {
-            if (!board[r][c].isEmpty() && board[r][c].color == attackerColor) {
-                std::vector<Move> pieceMoves;
-                generateMovesForPiece(r, c, pieceMoves);
-                for (const auto& move : pieceMoves) {
-                    if (move.toRow == row && move.toCol == col) {
-                        return true;
-                    }
-                }
+template <PieceColor Us, GenType Type>
+void ChessGame::generateMoves(std::vector<Move>& moves) const {
+    if constexpr (Type == GenType::EVASIONS) {
+        generateEvasions<Us>(moves);
+    }
+    else {
+        moves.clear();
+        for (int r = 0; r < BOARD_SIZE; ++r) {
+            for (int c = 0; c < BOARD_SIZE; ++c) {
+                if (board[r][c].color == Us) generatePieceMoves<Us, Type>(r, c, moves);
             }
         }
     }
-    return false;
+}
+
+void ChessGame::generateMoves(PieceColor color, GenType type, std::vector<Move>& moves) const {
+    bool white = (color == PieceColor::WHITE);
+    switch (type) {
+    case GenType::ALL: white ? generateMoves<PieceColor::WHITE, GenType::ALL>(moves) : generateMoves<PieceColor::BLACK, GenType::ALL>(moves); break;
+    case GenType::CAPTURES: white ? generateMoves<PieceColor::WHITE, GenType::CAPTURES>(moves) : generateMoves<PieceColor::BLACK, GenType::CAPTURES>(moves); break;
+    case GenType::QUIETS: white ? generateMoves<PieceColor::WHITE, GenType::QUIETS>(moves) : generateMoves<PieceColor::BLACK, GenType::QUIETS>(moves); break;
+    case GenType::EVASIONS: white ? generateMoves<PieceColor::WHITE, GenType::EVASIONS>(moves) : generateMoves<PieceColor::BLACK, GenType::EVASIONS>(moves); break;
+    }
+}
+
+void ChessGame::generateMovesForPiece(int row, int col, std::vector<Move>& moves) const {
+    switch (board[row][col].color) {
+    case PieceColor::WHITE: generatePieceMoves<PieceColor::WHITE, GenType::ALL>(row, col, moves); break;
+    case PieceColor::BLACK: generatePieceMoves<PieceColor::BLACK, GenType::ALL>(row, col, moves); break;
+    default: break;
+    }
+}
+
+void ChessGame::generatePseudoLegalMoves(PieceColor color, std::vector<Move>& moves) const {
+    if (color == PieceColor::WHITE) generateMoves<PieceColor::WHITE, GenType::ALL>(moves);
+    else generateMoves<PieceColor::BLACK, GenType::ALL>(moves);
+}
+
+int ChessGame::findKing(PieceColor color, int& row, int& col) const {
+    int king = kingSquare[colorIndex(color)];
+    if (king < 0) return 0;
+    row = king / 8;
+    col = king % 8;
+    return 1;
+}
+
+bool ChessGame::isSquareAttacked(int row, int col, PieceColor attackerColor) const {
+    return isAttackedBy(row * 8 + col, attackerColor);
 }
 
 bool ChessGame::isInCheck(PieceColor color) const {
-    int kingRow, kingCol;
-    if (!findKing(color, kingRow, kingCol)) return false;
-    PieceColor attacker = (color == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
-    return isSquareAttacked(kingRow, kingCol, attacker);
+    int king = kingSquare[colorIndex(color)];
+    return king >= 0 && isAttackedBy(king, (color == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE);
 }
 
 bool ChessGame::isLegalMove(const Move& move, PieceColor color) const {
-    // Save board state
-    std::array<std::array<Piece, BOARD_SIZE>, BOARD_SIZE> savedBoard = board;
-    bool savedWhiteKingMoved = whiteKingMoved;
-    bool savedWhiteRookLeftMoved = whiteRookLeftMoved;
-    bool savedWhiteRookRightMoved = whiteRookRightMoved;
-    bool savedBlackKingMoved = blackKingMoved;
-    bool savedBlackRookLeftMoved = blackRookLeftMoved;
-    bool savedBlackRookRightMoved = blackRookRightMoved;
-    int savedEnPassantRow = enPassantRow;
-    int savedEnPassantCol = enPassantCol;
+    SavedState saved = saveState();
 
     // Temporarily make the move (const_cast needed because applyMove modifies state)
     ChessGame* nonConstThis = const_cast<ChessGame*>(this);
@@ -312,16 +592,7 @@ bool ChessGame::isLegalMove(const Move& move, PieceColor color) const {
     // Check if this move leaves own king in check
     bool legal = !isInCheck(color);
 
-    // Restore board state
-    nonConstThis->board = savedBoard;
-    nonConstThis->whiteKingMoved = savedWhiteKingMoved;
-    nonConstThis->whiteRookLeftMoved = savedWhiteRookLeftMoved;
-    nonConstThis->whiteRookRightMoved = savedWhiteRookRightMoved;
-    nonConstThis->blackKingMoved = savedBlackKingMoved;
-    nonConstThis->blackRookLeftMoved = savedBlackRookLeftMoved;
-    nonConstThis->blackRookRightMoved = savedBlackRookRightMoved;
-    nonConstThis->enPassantRow = savedEnPassantRow;
-    nonConstThis->enPassantCol = savedEnPassantCol;
+    nonConstThis->restoreState(saved);
 
     return legal;
 }
@@ -338,6 +609,28 @@ bool ChessGame::hasLegalMoves(PieceColor color) const {
     return !moves.empty();
 }
 
+const std::vector<Move>& ChessGame::currentLegalMoves() const {
+    if (legalMovesVersion != positionVersion) {
+        generatePseudoLegalMoves(currentPlayer, legalMoves);
+        validateMoves(legalMoves, currentPlayer);
+        legalFirst.fill(0);
+        legalCount.fill(0);
+        for (size_t i = legalMoves.size(); i-- > 0;) {
+            int sq = legalMoves[i].fromRow * 8 + legalMoves[i].fromCol;
+            legalFirst[sq] = (uint8_t)i;
+            ++legalCount[sq];
+        }
+        legalMovesVersion = positionVersion;
+    }
+    return legalMoves;
+}
+
+void ChessGame::legalMovesFrom(int row, int col, std::vector<Move>& out) const {
+    const std::vector<Move>& moves = currentLegalMoves();
+    int sq = row * 8 + col;
+    out.assign(moves.begin() + legalFirst[sq], moves.begin() + legalFirst[sq] + legalCount[sq]);
+}
+
 bool ChessGame::isCheckmate(PieceColor color) const {
     return isInCheck(color) && !hasLegalMoves(color);
 }
@@ -348,42 +641,44 @@ bool ChessGame::isStalemate(PieceColor color) const {
 
 Piece ChessGame::applyMove(const Move& move) {
     Piece captured = board[move.toRow][move.toCol];
-    bool isCastlingMove = move.isCastling || (board[move.fromRow][move.fromCol].type == PieceType::KING && abs(move.fromCol - move.toCol) == 2);
+    Piece mover = board[move.fromRow][move.fromCol];
+    const Piece empty{ PieceType::EMPTY, PieceColor::NONE };
+    bool isCastlingMove = move.isCastling || (mover.type == PieceType::KING && abs(move.fromCol - move.toCol) == 2);
 
     // Handle castling
     if (isCastlingMove) {
         // Move king
-        board[move.toRow][move.toCol] = board[move.fromRow][move.fromCol];
-        board[move.fromRow][move.fromCol] = Piece{ PieceType::EMPTY, PieceColor::NONE };
+        setSquare(move.toRow, move.toCol, mover);
+        setSquare(move.fromRow, move.fromCol, empty);
         // Move rook
         if (move.toCol == 6) { // Kingside
-            board[move.fromRow][5] = board[move.fromRow][7];
-            board[move.fromRow][7] = Piece{ PieceType::EMPTY, PieceColor::NONE };
+            setSquare(move.fromRow, 5, board[move.fromRow][7]);
+            setSquare(move.fromRow, 7, empty);
         }
         else if (move.toCol == 2) { // Queenside
-            board[move.fromRow][3] = board[move.fromRow][0];
-            board[move.fromRow][0] = Piece{ PieceType::EMPTY, PieceColor::NONE };
+            setSquare(move.fromRow, 3, board[move.fromRow][0]);
+            setSquare(move.fromRow, 0, empty);
         }
     }
     // Handle en passant
-    else if (move.isEnPassant || (board[move.fromRow][move.fromCol].type == PieceType::PAWN && move.toCol != move.fromCol && board[move.toRow][move.toCol].isEmpty())) {
-        board[move.toRow][move.toCol] = board[move.fromRow][move.fromCol];
-        board[move.fromRow][move.fromCol] = Piece{ PieceType::EMPTY, PieceColor::NONE };
+    else if (move.isEnPassant || (mover.type == PieceType::PAWN && move.toCol != move.fromCol && captured.isEmpty())) {
+        setSquare(move.toRow, move.toCol, mover);
+        setSquare(move.fromRow, move.fromCol, empty);
         // Capture the pawn that was passed
-        int capturedPawnRow = (board[move.toRow][move.toCol].color == PieceColor::WHITE) ? move.toRow + 1 : move.toRow - 1;
+        int capturedPawnRow = (mover.color == PieceColor::WHITE) ? move.toRow + 1 : move.toRow - 1;
         if (isValidSquare(capturedPawnRow, move.toCol)) {
-            board[capturedPawnRow][move.toCol] = Piece{ PieceType::EMPTY, PieceColor::NONE };
+            setSquare(capturedPawnRow, move.toCol, empty);
         }
     }
     // Handle pawn promotion
-    else if (board[move.fromRow][move.fromCol].type == PieceType::PAWN && (move.toRow == 0 || move.toRow == 7)) {
-        board[move.toRow][move.toCol] = Piece{ move.promotion, board[move.fromRow][move.fromCol].color };
-        board[move.fromRow][move.fromCol] = Piece{ PieceType::EMPTY, PieceColor::NONE };
+    else if (mover.type == PieceType::PAWN && (move.toRow == 0 || move.toRow == 7)) {
+        setSquare(move.toRow, move.toCol, Piece{ move.promotion, mover.color });
+        setSquare(move.fromRow, move.fromCol, empty);
     }
     // Normal move
     else {
-        board[move.toRow][move.toCol] = board[move.fromRow][move.fromCol];
-        board[move.fromRow][move.fromCol] = Piece{ PieceType::EMPTY, PieceColor::NONE };
+        setSquare(move.toRow, move.toCol, mover);
+        setSquare(move.fromRow, move.fromCol, empty);
     }
 
     // Update castling rights
@@ -397,6 +692,11 @@ Piece ChessGame::applyMove(const Move& move) {
         if (move.fromRow == 0 && move.fromCol == 0) blackRookLeftMoved = true;
         if (move.fromRow == 0 && move.fromCol == 7) blackRookRightMoved = true;
     }
+    // A rook captured on its home corner can no longer castle either
+    if (move.toRow == 7 && move.toCol == 0) whiteRookLeftMoved = true;
+    if (move.toRow == 7 && move.toCol == 7) whiteRookRightMoved = true;
+    if (move.toRow == 0 && move.toCol == 0) blackRookLeftMoved = true;
+    if (move.toRow == 0 && move.toCol == 7) blackRookRightMoved = true;
 
     // Update en passant target
     enPassantRow = enPassantCol = -1;
@@ -408,6 +708,30 @@ Piece ChessGame::applyMove(const Move& move) {
     return captured;
 }
 
+ChessGame::SavedState ChessGame::saveState() const {
+    return SavedState{ board,
+        whiteKingMoved, whiteRookLeftMoved, whiteRookRightMoved,
+        blackKingMoved, blackRookLeftMoved, blackRookRightMoved,
+        enPassantRow, enPassantCol,
+        attackCount, controlledSquares, kingSquare, materialKey };
+}
+
+void ChessGame::restoreState(const SavedState& saved) {
+    board = saved.board;
+    whiteKingMoved = saved.whiteKingMoved;
+    whiteRookLeftMoved = saved.whiteRookLeftMoved;
+    whiteRookRightMoved = saved.whiteRookRightMoved;
+    blackKingMoved = saved.blackKingMoved;
+    blackRookLeftMoved = saved.blackRookLeftMoved;
+    blackRookRightMoved = saved.blackRookRightMoved;
+    enPassantRow = saved.enPassantRow;
+    enPassantCol = saved.enPassantCol;
+    attackCount = saved.attackCount;
+    controlledSquares = saved.controlledSquares;
+    kingSquare = saved.kingSquare;
+    materialKey = saved.materialKey;
+}
+
 void ChessGame::unmakeMove(const Move& move, Piece capturedPiece) {
     // Restore the board state - simplified version
     // For castling, we'd need to restore rook positions too, but this is called during minimax
@@ -416,7 +740,9 @@ void ChessGame::unmakeMove(const Move& move, Piece capturedPiece) {
 
 void ChessGame::makeMove(const Move& move) {
     applyMove(move);
+    history.push_back(move);
     currentPlayer = (currentPlayer == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    ++positionVersion;
     selectedRow = selectedCol = -1;
     highlightedMoves.clear();
     checkGameState();
@@ -424,13 +750,19 @@ void ChessGame::makeMove(const Move& move) {
 
 void ChessGame::checkGameState() {
     AisInCheck = isInCheck(currentPlayer);
-    if (isCheckmate(currentPlayer)) {
-        gameOver = true;
+    if (!currentLegalMoves().empty()) {
+        if (ChessEndgames::isDeadDraw(*this)) {
+            gameOver = true;
+            AisInsufficientMaterial = true;
+        }
+        return;
+    }
+    gameOver = true;
+    if (AisInCheck) {
         AisCheckmate = true;
         winner = (currentPlayer == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
     }
-    else if (isStalemate(currentPlayer)) {
-        gameOver = true;
+    else {
         AisStalemate = true;
     }
 }
@@ -446,8 +778,21 @@ int ChessGame::getPieceValue(PieceType type) const {
     }
 }
 
+// Enemy attacks on the 3x3 zone around the king of color `king`
+int ChessGame::kingZonePressure(PieceColor king) const {
+    int square = kingSquare[colorIndex(king)];
+    if (square < 0) return 0;
+    const auto& enemy = attackCount[colorIndex(king) ^ 1];
+    const ChessTables::SquareList& zone = kGeo.king[square];
+    int pressure = enemy[square];
+    for (int i = 0; i < zone.count; ++i) pressure += enemy[zone.squares[i]];
+    return pressure;
+}
+
 int ChessGame::evaluateBoard() const {
-    int score = 0;
+    // Square control and king safety, read straight from the attack maps
+    int score = CONTROL_WEIGHT * (controlledSquares[0] - controlledSquares[1])
+        - KING_ZONE_WEIGHT * (kingZonePressure(PieceColor::WHITE) - kingZonePressure(PieceColor::BLACK));
     for (int r = 0; r < BOARD_SIZE; ++r) {
         for (int c = 0; c < BOARD_SIZE; ++c) {
             if (!board[r][c].isEmpty()) {
@@ -464,125 +809,164 @@ int ChessGame::evaluateBoard() const {
     return score;
 }
 
-int ChessGame::minimax(int depth, int alpha, int beta, bool maximizing, PieceColor color) {
-    if (depth == 0) return evaluateBoard();
+// Mate scores are stored relative to the node so they stay valid at any ply
+static int scoreToTT(int score, int ply) {
+    if (score > 900000) return score + ply;
+    if (score < -900000) return score - ply;
+    return score;
+}
+
+static int scoreFromTT(int score, int ply) {
+    if (score > 900000) return score - ply;
+    if (score < -900000) return score + ply;
+    return score;
+}
+
+int ChessGame::minimax(int depth, int ply, int alpha, int beta, PieceColor color) {
+    ++nodes;
+    if (stopFlag && stopFlag->load(std::memory_order_relaxed)) return 0;
+
+    bool maximizing = (color == PieceColor::WHITE);
+    uint64_t key = tt ? computeHash(color) : 0;
+    uint16_t ttMove = 0;
+    if (tt) {
+        TTEntry e;
+        if (tt->probe(key, e)) {
+            ttMove = e.move;
+            if (e.depth >= depth) {
+                int s = scoreFromTT(e.score, ply);
+                if (e.bound == TTBound::EXACT) return s;
+                if (e.bound == TTBound::LOWER && s >= beta) return s;
+                if (e.bound == TTBound::UPPER && s <= alpha) return s;
+            }
+        }
+    }
+
+    // Known endings: dead draws end the line, basic mates give a bound or a mop-up evaluation
+    EndgameScore known;
+    bool recognized = ChessEndgames::probe(*this, color, known);
+    if (recognized) {
+        if (known.bound == TTBound::EXACT) return known.score;
+        if (known.bound == TTBound::LOWER && known.score >= beta) return known.score;
+        if (known.bound == TTBound::UPPER && known.score <= alpha) return known.score;
+    }
+
+    if (depth == 0) return recognized ? known.score : evaluateBoard();
 
-    bool inCheck = isInCheck(color);
+    // Evasion generation only produces check-resolving moves and falls back to all moves otherwise
     std::vector<Move> moves;
-    generatePseudoLegalMoves(color, moves);
+    generateMoves(color, GenType::EVASIONS, moves);
     validateMoves(moves, color);
 
     if (moves.empty()) {
-        if (inCheck) return -1000000 + depth; // Checkmate
+        if (isInCheck(color)) return maximizing ? -MATE_SCORE + ply : MATE_SCORE - ply; // Checkmate (sooner is more extreme)
         return 0; // Stalemate
     }
 
-    // Save board state
-    std::array<std::array<Piece, BOARD_SIZE>, BOARD_SIZE> savedBoard = board;
-    bool savedWhiteKingMoved = whiteKingMoved;
-    bool savedWhiteRookLeftMoved = whiteRookLeftMoved;
-    bool savedWhiteRookRightMoved = whiteRookRightMoved;
-    bool savedBlackKingMoved = blackKingMoved;
-    bool savedBlackRookLeftMoved = blackRookLeftMoved;
-    bool savedBlackRookRightMoved = blackRookRightMoved;
-    int savedEnPassantRow = enPassantRow;
-    int savedEnPassantCol = enPassantCol;
-
-    if (maximizing) {
-        int best = -10000000;
-        for (const auto& move : moves) {
-            applyMove(move);
-            int val = minimax(depth - 1, alpha, beta, false, (color == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE);
-            // Restore board state
-            board = savedBoard;
-            whiteKingMoved = savedWhiteKingMoved;
-            whiteRookLeftMoved = savedWhiteRookLeftMoved;
-            whiteRookRightMoved = savedWhiteRookRightMoved;
-            blackKingMoved = savedBlackKingMoved;
-            blackRookLeftMoved = savedBlackRookLeftMoved;
-            blackRookRightMoved = savedBlackRookRightMoved;
-            enPassantRow = savedEnPassantRow;
-            enPassantCol = savedEnPassantCol;
-
-            best = std::max(best, val);
-            alpha = std::max(alpha, best);
-            if (beta <= alpha) break;
-        }
-        return best;
+    // Try the TT move first
+    if (ttMove) {
+        for (size_t i = 0; i < moves.size(); ++i) {
+            if (packMove(moves[i]) == ttMove) { std::swap(moves[0], moves[i]); break; }
+        }
     }
-    else {
-        int best = 10000000;
-        for (const auto& move : moves) {
-            applyMove(move);
-            int val = minimax(depth - 1, alpha, beta, true, (color == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE);
-            // Restore board state
-            board = savedBoard;
-            whiteKingMoved = savedWhiteKingMoved;
-            whiteRookLeftMoved = savedWhiteRookLeftMoved;
-            whiteRookRightMoved = savedWhiteRookRightMoved;
-            blackKingMoved = savedBlackKingMoved;
-            blackRookLeftMoved = savedBlackRookLeftMoved;
-            blackRookRightMoved = savedBlackRookRightMoved;
-            enPassantRow = savedEnPassantRow;
-            enPassantCol = savedEnPassantCol;
 
-            best = std::min(best, val);
-            beta = std::min(beta, best);
-            if (beta <= alpha) break;
-        }
-        return best;
+    SavedState saved = saveState();
+
+    int alphaOrig = alpha, betaOrig = beta;
+    int best = maximizing ? -INF_SCORE : INF_SCORE;
+    uint16_t bestMove = 0;
+    PieceColor opponent = (color == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    for (const auto& move : moves) {
+        applyMove(move);
+        int val = minimax(depth - 1, ply + 1, alpha, beta, opponent);
+        restoreState(saved);
+
+        if (maximizing ? val > best : val < best) { best = val; bestMove = packMove(move); }
+        if (maximizing) alpha = std::max(alpha, best);
+        else beta = std::min(beta, best);
+        if (beta <= alpha) break;
+    }
+
+    if (stopFlag && stopFlag->load(std::memory_order_relaxed)) return best; // partial result, don't store
+    if (tt) {
+        TTBound bound = (best <= alphaOrig) ? TTBound::UPPER : (best >= betaOrig) ? TTBound::LOWER : TTBound::EXACT;
+        tt->store(key, depth, scoreToTT(best, ply), bound, bestMove);
     }
+    return best;
 }
 
-Move ChessGame::aiChooseMove() {
+Move ChessGame::searchBestMove(PieceColor side, int depth, int* scoreOut) {
     std::vector<Move> moves;
-    generatePseudoLegalMoves(PieceColor::BLACK, moves);
-    validateMoves(moves, PieceColor::BLACK);
-
-    if (moves.empty()) return Move(-1, -1, -1, -1);
-
-    if (difficulty == GameDifficulty::EASY) {
-        return moves[GetRandomValue(0, (int)moves.size() - 1)];
+    if (side == currentPlayer) {
+        moves = currentLegalMoves();
     }
+    else {
+        generatePseudoLegalMoves(side, moves);
+        validateMoves(moves, side);
+    }
+    if (moves.empty()) return Move(-1, -1, -1, -1);
 
-    int maxDepth = (difficulty == GameDifficulty::MEDIUM) ? 2 : 4;
-    int bestVal = -10000000;
+    bool maximizing = (side == PieceColor::WHITE);
+    PieceColor opponent = maximizing ? PieceColor::BLACK : PieceColor::WHITE;
+    int bestVal = maximizing ? -INF_SCORE : INF_SCORE;
     Move bestMove = moves[0];
 
-    // Save board state
-    std::array<std::array<Piece, BOARD_SIZE>, BOARD_SIZE> savedBoard = board;
-    bool savedWhiteKingMoved = whiteKingMoved;
-    bool savedWhiteRookLeftMoved = whiteRookLeftMoved;
-    bool savedWhiteRookRightMoved = whiteRookRightMoved;
-    bool savedBlackKingMoved = blackKingMoved;
-    bool savedBlackRookLeftMoved = blackRookLeftMoved;
-    bool savedBlackRookRightMoved = blackRookRightMoved;
-    int savedEnPassantRow = enPassantRow;
-    int savedEnPassantCol = enPassantCol;
+    SavedState saved = saveState();
 
     for (const auto& move : moves) {
         applyMove(move);
-        int val = minimax(maxDepth - 1, -10000000, 10000000, false, PieceColor::WHITE);
-        // Restore board state
-        board = savedBoard;
-        whiteKingMoved = savedWhiteKingMoved;
-        whiteRookLeftMoved = savedWhiteRookLeftMoved;
-        whiteRookRightMoved = savedWhiteRookRightMoved;
-        blackKingMoved = savedBlackKingMoved;
-        blackRookLeftMoved = savedBlackRookLeftMoved;
-        blackRookRightMoved = savedBlackRookRightMoved;
-        enPassantRow = savedEnPassantRow;
-        enPassantCol = savedEnPassantCol;
-
-        if (val > bestVal) {
+        int val = maximizing ? minimax(depth - 1, 1, bestVal, INF_SCORE, opponent) : minimax(depth - 1, 1, -INF_SCORE, bestVal, opponent);
+        restoreState(saved);
+
+        if (maximizing ? val > bestVal : val < bestVal) {
             bestVal = val;
             bestMove = move;
         }
     }
 
+    if (scoreOut) *scoreOut = bestVal;
     return bestMove;
 }
 
+Move ChessGame::aiChooseMove() {
+    const std::vector<Move>& moves = currentLegalMoves();
+    if (moves.empty()) return Move(-1, -1, -1, -1);
+
+    if (difficulty == GameDifficulty::EASY) {
+        return moves[GetRandomValue(0, (int)moves.size() - 1)];
+    }
+
+    // Sharp positions: look for a forced mate with the proof-number solver first
+    if (isSharpPosition(PieceColor::BLACK)) {
+        MateSolver solver(4);
+        MateResult mate = solver.findMate(*this, PieceColor::BLACK, (difficulty == GameDifficulty::MEDIUM) ? 2 : 3, 50000);
+        if (mate.found) return mate.line[0];
+    }
+
+    // The AI plays Black, so it minimizes the White-relative score
+    int maxDepth = (difficulty == GameDifficulty::MEDIUM) ? 2 : 4;
+    return searchBestMove(PieceColor::BLACK, maxDepth);
+}
+
+bool ChessGame::isSharpPosition(PieceColor color) const {
+    if (isInCheck(color)) return true;
+    // Count moves that give check; two or more usually means forcing play
+    PieceColor opponent = (color == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    std::vector<Move> moves;
+    generatePseudoLegalMoves(color, moves);
+    int checks = 0;
+    SavedState saved = saveState();
+
+    ChessGame* nonConstThis = const_cast<ChessGame*>(this);
+    for (const auto& move : moves) {
+        nonConstThis->applyMove(move);
+        if (!isInCheck(color) && isInCheck(opponent)) ++checks;
+        nonConstThis->restoreState(saved);
+        if (checks >= 2) return true;
+    }
+    return false;
+}
+
 void ChessGame::aiTurn() {
     Move move = aiChooseMove();
     if (move.fromRow >= 0) {
@@ -592,9 +976,38 @@ void ChessGame::aiTurn() {
 
 void ChessGame::update(GameState& stateOut) {
     if (IsKeyPressed(KEY_M)) { stateOut = GameState::STATE_MENU; return; }
-    if (IsKeyPressed(KEY_R)) { reset(); return; }
+    if (IsKeyPressed(KEY_R)) {
+        if (reviewer) reviewer->cancel();
+        reset();
+        return;
+    }
+    if (IsKeyPressed(KEY_A) && analyzer) {
+        analysisEnabled = !analysisEnabled;
+        analyzedKey = 0;
+        if (!analysisEnabled) analyzer->stop();
+    }
 
-    if (gameOver) return;
+    // Keep the background analysis on the position the human is thinking about
+    if (analysisEnabled && analyzer) {
+        if (gameOver || currentPlayer != PieceColor::WHITE) {
+            if (analyzedKey != 0) { analyzer->stop(); analyzedKey = 0; }
+        }
+        else {
+            uint64_t key = computeHash(currentPlayer);
+            if (key != analyzedKey) { analyzedKey = key; analyzer->analyze(*this, currentPlayer); }
+        }
+    }
+
+    if (gameOver) {
+        // Review the finished game in the background; V hides the report to show the board
+        if (reviewer && !reviewRequested && !history.empty()) {
+            reviewer->start(*this);
+            reviewRequested = true;
+            reviewVisible = true;
+        }
+        if (IsKeyPressed(KEY_V)) reviewVisible = !reviewVisible;
+        return;
+    }
 
     if (currentPlayer == PieceColor::WHITE) {
         // Human turn
@@ -607,9 +1020,7 @@ void ChessGame::update(GameState& stateOut) {
                     if (!board[row][col].isEmpty() && board[row][col].color == PieceColor::WHITE) {
                         selectedRow = row;
                         selectedCol = col;
-                        highlightedMoves.clear();
-                        generateMovesForPiece(row, col, highlightedMoves);
-                        validateMoves(highlightedMoves, PieceColor::WHITE);
+                        legalMovesFrom(row, col, highlightedMoves);
                     }
                 }
                 else {
@@ -627,9 +1038,7 @@ void ChessGame::update(GameState& stateOut) {
                         if (!board[row][col].isEmpty() && board[row][col].color == PieceColor::WHITE) {
                             selectedRow = row;
                             selectedCol = col;
-                            highlightedMoves.clear();
-                            generateMovesForPiece(row, col, highlightedMoves);
-                            validateMoves(highlightedMoves, PieceColor::WHITE);
+                            legalMovesFrom(row, col, highlightedMoves);
                         }
                         else {
                             selectedRow = selectedCol = -1;
@@ -771,6 +1180,9 @@ void ChessGame::draw() const {
     // Draw board border
     DrawRectangleLinesEx(boardRect, 3.0f, Color{ 100, 100, 100, 255 });
 
+    drawAnalysis();
+    drawReview();
+
     // Status text
     std::string status;
     if (gameOver) {
@@ -780,6 +1192,10 @@ void ChessGame::draw() const {
         else if (AisStalemate) {
             status = "Stalemate! Draw!";
         }
+        else if (AisInsufficientMaterial) {
+            status = "Insufficient material! Draw!";
+        }
+        if (reviewRequested) status += " (V: review)";
     }
     else {
         status = (currentPlayer == PieceColor::WHITE) ? "Your turn (White)" : "AI thinking (Black)...";
@@ -797,8 +1213,106 @@ void ChessGame::draw() const {
     Vector2 tSize = MeasureTextEx(uiFont, title, 32.0f, 2.0f);
     DrawTextEx(uiFont, title, { GetScreenWidth() * 0.5f - tSize.x * 0.5f, boardRect.y - 60 }, 32.0f, 2.0f, RAYWHITE);
 
-    const char* hint = "Click a piece to select. R to restart. M for Menu.";
+    const char* hint = "Click a piece to select. R to restart. M for Menu. A to analyze.";
     Vector2 hSize = MeasureTextEx(uiFont, hint, 20.0f, 2.0f);
     DrawTextEx(uiFont, hint, { GetScreenWidth() * 0.5f - hSize.x * 0.5f-30, boardRect.y-25 }, 25.0f, 2.0f, Color{ 200, 210, 225, 255 });
 }
 
+std::string formatScore(int score) {
+    char buf[32];
+    if (std::abs(score) > ChessGame::MATE_SCORE - 100000) {
+        int plies = ChessGame::MATE_SCORE - std::abs(score);
+        snprintf(buf, sizeof(buf), "#%s%d", score > 0 ? "+" : "-", (plies + 1) / 2);
+    }
+    else {
+        snprintf(buf, sizeof(buf), "%+.2f", score / 100.0f);
+    }
+    return buf;
+}
+
+void ChessGame::drawAnalysis() const {
+    if (!analysisEnabled || !analyzer) return;
+    const AnalysisSnapshot& snap = analyzer->latest();
+    float textY = boardRect.y + boardRect.height + 48;
+    if (snap.key != computeHash(currentPlayer) || snap.lineCount == 0) {
+        if (!gameOver && currentPlayer == PieceColor::WHITE) {
+            DrawTextEx(uiFont, "Analyzing...", { boardRect.x, textY }, 18.0f, 1.0f, Color{ 200, 210, 225, 255 });
+        }
+        return;
+    }
+
+    // Arrows for the first move of each line, best line drawn last (on top)
+    for (int i = snap.lineCount - 1; i >= 0; --i) {
+        if (snap.lines[i].pvLength == 0) continue;
+        Move m = unpackMove(snap.lines[i].pv[0]);
+        Vector2 a = squareCenter(m.fromRow, m.fromCol);
+        Vector2 b = squareCenter(m.toRow, m.toCol);
+        float dx = b.x - a.x, dy = b.y - a.y;
+        float len = sqrtf(dx * dx + dy * dy);
+        if (len < 1.0f) continue;
+        dx /= len; dy /= len;
+        float head = cellSize * 0.35f;
+        float width = (i == 0) ? cellSize * 0.14f : cellSize * 0.09f;
+        Color col = (i == 0) ? Color{ 60, 170, 90, 200 } : Color{ 70, 130, 230, (unsigned char)(170 - 40 * i) };
+        Vector2 base = { b.x - dx * head, b.y - dy * head };
+        DrawLineEx(a, base, width, col);
+        Vector2 left = { base.x - dy * head * 0.6f, base.y + dx * head * 0.6f };
+        Vector2 right = { base.x + dy * head * 0.6f, base.y - dx * head * 0.6f };
+        // raylib wants counter-clockwise vertices
+        if ((left.x - b.x) * (right.y - b.y) - (left.y - b.y) * (right.x - b.x) > 0) std::swap(left, right);
+        DrawTriangle(b, left, right, col);
+    }
+
+    for (int i = 0; i < snap.lineCount; ++i) {
+        std::string text = std::to_string(i + 1) + ". " + formatScore(snap.lines[i].score) + "  ";
+        for (int p = 0; p < snap.lines[i].pvLength; ++p) text += moveToString(unpackMove(snap.lines[i].pv[p])) + " ";
+        if (i == 0) text += " (depth " + std::to_string(snap.depth) + ")";
+        DrawTextEx(uiFont, text.c_str(), { boardRect.x, textY + i * 20.0f }, 18.0f, 1.0f, Color{ 200, 210, 225, 255 });
+    }
+}
+
+void ChessGame::drawReview() const {
+    if (!gameOver || !reviewer || !reviewRequested || !reviewVisible || !reviewer->started()) return;
+    const Color text = { 200, 210, 225, 255 };
+    DrawRectangleRec(boardRect, Color{ 20, 27, 40, 225 });
+    float x = boardRect.x + 16, y = boardRect.y + 14;
+    DrawTextEx(uiFont, "Game review", { x, y }, 26.0f, 2.0f, RAYWHITE);
+    y += 36;
+
+    char line[160];
+    if (reviewer->running()) {
+        snprintf(line, sizeof(line), "Reviewing... %d / %d positions", reviewer->completed(), reviewer->total());
+        DrawTextEx(uiFont, line, { x, y }, 18.0f, 1.0f, text);
+        return;
+    }
+
+    const std::vector<ReviewedMove>& moves = reviewer->moves();
+    ReviewSummary s = GameReviewer::summarize(moves);
+    for (int side = 0; side < 2; ++side) {
+        snprintf(line, sizeof(line), "%s: avg loss %d cp, %d inaccuracies, %d mistakes, %d blunders",
+            side == 0 ? "White" : "Black", s.averageLoss[side], s.inaccuracies[side], s.mistakes[side], s.blunders[side]);
+        DrawTextEx(uiFont, line, { x, y }, 18.0f, 1.0f, text);
+        y += 22;
+    }
+    y += 10;
+
+    // Inaccuracies and worse, in game order, as many as fit on the board
+    int number = 1, shown = 0;
+    for (const ReviewedMove& m : moves) {
+        if (m.grade >= MoveGrade::INACCURACY && y + 20 < boardRect.y + boardRect.height - 24) {
+            Color col = (m.grade == MoveGrade::BLUNDER) ? Color{ 230, 90, 80, 255 }
+                : (m.grade == MoveGrade::MISTAKE) ? Color{ 235, 160, 70, 255 } : Color{ 225, 210, 100, 255 };
+            snprintf(line, sizeof(line), "%d%s %s%s  %s -> %s  best %s  (-%d)", number, (m.mover == PieceColor::BLACK) ? "..." : ".",
+                m.san.c_str(), GameReviewer::gradeSuffix(m.grade), formatScore(m.bestScore).c_str(),
+                formatScore(m.playedScore).c_str(), m.bestSan.c_str(), m.loss);
+            DrawTextEx(uiFont, line, { x, y }, 18.0f, 1.0f, col);
+            y += 20;
+            ++shown;
+        }
+        if (m.mover == PieceColor::BLACK) ++number;
+    }
+    if (shown == 0) DrawTextEx(uiFont, "No inaccuracies found.", { x, y }, 18.0f, 1.0f, text);
+
+    snprintf(line, sizeof(line), "%d positions reviewed in %.1fs", reviewer->total(), reviewer->seconds());
+    DrawTextEx(uiFont, line, { x, boardRect.y + boardRect.height - 26 }, 16.0f, 1.0f, text);
+}
@@ -1,6 +1,10 @@
 #pragma once
 #include "raylib.h"
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 #include "Menu.h" // for GameState enum
 #include "globals.h"
@@ -13,6 +17,7 @@
 
 enum class PieceType { EMPTY, KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN };
 enum class PieceColor { NONE, WHITE, BLACK };
+enum class GenType { ALL, CAPTURES, QUIETS, EVASIONS }; // move generation filters
 
 
 struct Piece {
@@ -26,12 +31,43 @@ struct Move {
     int fromRow, fromCol;
     int toRow, toCol;
     PieceType promotion = PieceType::QUEEN; // For pawn promotion
+    bool isPromotion = false; // a pawn reaching the last rank; only then does `promotion` apply
     bool isCastling = false;
     bool isEnPassant = false;
 
     Move(int fr, int fc, int tr, int tc) : fromRow(fr), fromCol(fc), toRow(tr), toCol(tc) {}
 };
 
+// 16-bit move encoding used by the transposition table: from(6) | to(6) | promotion(2) | isPromotion(1).
+// 0 = no move.
+inline uint16_t packMove(const Move& m) {
+    int promo = (m.promotion == PieceType::KNIGHT) ? 0 : (m.promotion == PieceType::BISHOP) ? 1 : (m.promotion == PieceType::ROOK) ? 2 : 3;
+    return (uint16_t)((m.fromRow * 8 + m.fromCol) | ((m.toRow * 8 + m.toCol) << 6) | (promo << 12) | ((m.isPromotion ? 1 : 0) << 14));
+}
+inline Move unpackMove(uint16_t v) {
+    static const PieceType promos[4] = { PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN };
+    int from = v & 63, to = (v >> 6) & 63;
+    Move m(from / 8, from % 8, to / 8, to % 8);
+    m.promotion = promos[(v >> 12) & 3];
+    m.isPromotion = (v >> 14) & 1;
+    return m;
+}
+
+// Coordinate notation ("e2e4", "e7e8q"); row 0 is rank 8.
+std::string moveToString(const Move& m);
+// White-relative score as "+0.35", or "#+3" / "#-2" for mates
+std::string formatScore(int score);
+
+class TranspositionTable;
+class ChessAnalyzer;
+class MateSolver;
+class ChessPerft;
+class PgnImporter;
+class GameDatabase;
+class ChessCluster;
+class ChessEndgames;
+class GameReviewer;
+
 class ChessGame {
 public:
     void init(int screenWidth, int screenHeight);
@@ -39,8 +75,37 @@ public:
     void draw() const;
     void setFont(Font f) { uiFont = f; }
     void setDifficulty(GameDifficulty d) { difficulty = d; }
+    void setAnalyzer(ChessAnalyzer* a) { analyzer = a; }
+    void setReviewer(GameReviewer* r) { reviewer = r; }
+
+    // Zobrist key of the current position with the given side to move
+    uint64_t computeHash(PieceColor sideToMove) const;
+
+    // Position setup and engine entry points (also used by the benchmarks)
+    bool loadFEN(const std::string& fen);
+    std::string toFEN(PieceColor sideToMove) const; // move counters are not tracked and written as "0 1"
+    Move searchBestMove(PieceColor side, int depth, int* scoreOut = nullptr);
+    PieceColor sideToMove() const { return currentPlayer; }
+    const std::vector<Move>& moveHistory() const { return history; } // moves played since reset/loadFEN
+    uint64_t nodeCount() const { return nodes; }
+    void resetNodeCount() { nodes = 0; }
+    static constexpr int MATE_SCORE = 1000000; // mate in n plies scores MATE_SCORE - n
+
+    // Deep search results kept across runs (see TTDiskCache); call after init
+    bool loadSearchCache(const std::string& path);
+    bool saveSearchCache(const std::string& path);
 
 private:
+    friend class ChessAnalyzer;
+    friend class MateSolver;
+    friend struct ChessBench;
+    friend class ChessPerft;
+    friend class PgnImporter;
+    friend class GameDatabase;
+    friend class ChessCluster;
+    friend class ChessEndgames;
+    friend class GameReviewer;
+
     static constexpr int BOARD_SIZE = 8;
     std::array<std::array<Piece, BOARD_SIZE>, BOARD_SIZE> board{};
     Rectangle boardRect{ 0,0,0,0 };
@@ -51,15 +116,27 @@ private:
     bool AisCheckmate = false;
     bool AisInCheck = false;
     bool AisStalemate = false;
-    
+    bool AisInsufficientMaterial = false;
+
     PieceColor winner = PieceColor::NONE;
 
+    // Move list of the current game, replayed from startFEN (empty = initial position) by reviews
+    std::string startFEN;
+    std::vector<Move> history;
+
     // Selection and moves
     int selectedRow = -1;
     int selectedCol = -1;
-    std::vector<Move> legalMoves;
     std::vector<Move> highlightedMoves; // Moves for selected piece
 
+    // Legal moves of the side to move, computed once per position (see currentLegalMoves).
+    // Moves are grouped by from-square; legalFirst/legalCount index that grouping.
+    uint64_t positionVersion = 0;
+    mutable uint64_t legalMovesVersion = ~0ULL;
+    mutable std::vector<Move> legalMoves;
+    mutable std::array<uint8_t, 64> legalFirst{};
+    mutable std::array<uint8_t, 64> legalCount{};
+
     // Castling rights
     bool whiteKingMoved = false;
     bool whiteRookLeftMoved = false;
@@ -77,6 +154,21 @@ private:
     int screenH = 0;
     GameDifficulty difficulty = GameDifficulty::HARD;
 
+    // Search state (shared TT survives copies, so background searches stay warm)
+    std::shared_ptr<TranspositionTable> tt;
+    const std::atomic<bool>* stopFlag = nullptr; // set by background searches to abort
+    uint64_t nodes = 0;
+
+    // Background analysis (owned by the caller, see setAnalyzer)
+    ChessAnalyzer* analyzer = nullptr;
+    bool analysisEnabled = false;
+    uint64_t analyzedKey = 0;
+
+    // Post-game review (owned by the caller, see setReviewer), started once the game ends
+    GameReviewer* reviewer = nullptr;
+    bool reviewRequested = false;
+    bool reviewVisible = false;
+
     // Material values for evaluation
     static constexpr int PAWN_VALUE = 100;
     static constexpr int KNIGHT_VALUE = 300;
@@ -84,27 +176,72 @@ private:
     static constexpr int ROOK_VALUE = 500;
     static constexpr int QUEEN_VALUE = 900;
     static constexpr int KING_VALUE = 0; // Not used in evaluation
+    static constexpr int CONTROL_WEIGHT = 2;   // per square attacked
+    static constexpr int KING_ZONE_WEIGHT = 6; // per enemy attack on the king's 3x3 zone
 
     void reset();
     void initBoard();
     Vector2 squareCenter(int row, int col) const;
     int squareFromMouse(Vector2 m, int& row, int& col) const;
 
-    // Move generation
+    // Move generation. The templates are specialized on side to move and generation type so
+    // color-dependent directions, ranks and castling squares are compile-time constants; the
+    // non-template entry points pick the instantiation once per call.
     void generatePseudoLegalMoves(PieceColor color, std::vector<Move>& moves) const;
+    void generateMoves(PieceColor color, GenType type, std::vector<Move>& moves) const;
     void generateMovesForPiece(int row, int col, std::vector<Move>& moves) const;
-    void generatePawnMoves(int row, int col, std::vector<Move>& moves) const;
-    void generateRookMoves(int row, int col, std::vector<Move>& moves) const;
-    void generateBishopMoves(int row, int col, std::vector<Move>& moves) const;
-    void generateQueenMoves(int row, int col, std::vector<Move>& moves) const;
-    void generateKnightMoves(int row, int col, std::vector<Move>& moves) const;
-    void generateKingMoves(int row, int col, std::vector<Move>& moves) const;
+    template <PieceColor Us, GenType Type> void generateMoves(std::vector<Move>& moves) const;
+    template <PieceColor Us> void generateEvasions(std::vector<Move>& moves) const;
+    template <PieceColor Us, GenType Type> void generatePieceMoves(int row, int col, std::vector<Move>& moves) const;
+    template <PieceColor Us, GenType Type> void generatePawnMoves(int row, int col, std::vector<Move>& moves) const;
+    template <PieceColor Us, GenType Type, int FirstDir, int LastDir> void generateSliderMoves(int row, int col, std::vector<Move>& moves) const;
+    template <PieceColor Us, GenType Type> void generateKnightMoves(int row, int col, std::vector<Move>& moves) const;
+    template <PieceColor Us, GenType Type> void generateKingMoves(int row, int col, std::vector<Move>& moves) const;
+    template <PieceColor Them> int attackersTo(int row, int col, int* squares, int maxCount) const;
 
     // Move validation
     bool isLegalMove(const Move& move, PieceColor color) const;
     bool isInCheck(PieceColor color) const;
     bool hasLegalMoves(PieceColor color) const;
     void validateMoves(std::vector<Move>& moves, PieceColor color) const;
+    const std::vector<Move>& currentLegalMoves() const;
+    void legalMovesFrom(int row, int col, std::vector<Move>& out) const;
+
+    // Attack maps: how many pieces of each color attack every square. applyMove keeps them in
+    // step with the board through setSquare(), so check and castling tests are table reads.
+    using AttackMaps = std::array<std::array<uint8_t, 64>, 2>;
+    AttackMaps attackCount{};
+    std::array<int, 2> controlledSquares{}; // squares with a nonzero count, per color
+    std::array<int, 2> kingSquare{ { -1, -1 } };
+    static constexpr int colorIndex(PieceColor c) { return (c == PieceColor::WHITE) ? 0 : 1; }
+    bool isAttackedBy(int square, PieceColor color) const { return attackCount[colorIndex(color)][square] != 0; }
+    void setSquare(int row, int col, Piece piece);
+    void addAttacks(int square, const Piece& piece, int delta);
+    void extendRaysThrough(int square, int delta);
+    void bumpAttack(int color, int square, int delta);
+    void computeAttackMaps();
+
+    // Material signature: a 4-bit count per color and non-king piece type, kept by setSquare()
+    // and used to look up endgame recognizers (see ChessEndgames)
+    uint64_t materialKey = 0;
+    static constexpr uint64_t materialUnit(const Piece& p) {
+        if (p.type == PieceType::EMPTY || p.type == PieceType::KING) return 0;
+        return 1ULL << ((colorIndex(p.color) * 5 + ((int)p.type - (int)PieceType::QUEEN)) * 4);
+    }
+
+    // Everything applyMove changes, for save/restore around trial moves
+    struct SavedState {
+        std::array<std::array<Piece, BOARD_SIZE>, BOARD_SIZE> board;
+        bool whiteKingMoved, whiteRookLeftMoved, whiteRookRightMoved;
+        bool blackKingMoved, blackRookLeftMoved, blackRookRightMoved;
+        int enPassantRow, enPassantCol;
+        AttackMaps attackCount;
+        std::array<int, 2> controlledSquares;
+        std::array<int, 2> kingSquare;
+        uint64_t materialKey;
+    };
+    SavedState saveState() const;
+    void restoreState(const SavedState& saved);
 
     // Move execution
     void makeMove(const Move& move);
@@ -119,9 +256,12 @@ private:
     // AI
     void aiTurn();
     Move aiChooseMove();
-    int minimax(int depth, int alpha, int beta, bool maximizing, PieceColor color);
+    int minimax(int depth, int ply, int alpha, int beta, PieceColor color); // score is from White's view
     int evaluateBoard() const;
+    int kingZonePressure(PieceColor king) const;
     int getPieceValue(PieceType type) const;
+    bool isSharpPosition(PieceColor color) const;
+    static constexpr int INF_SCORE = 10000000;
 
     // Utility
     bool isValidSquare(int row, int col) const;
@@ -132,6 +272,7 @@ private:
     //const char* getPieceUnicode(PieceType type, PieceColor color) const;
     int getPieceCodepoint(PieceType type, PieceColor color) const;
     Color getSquareColor(int row, int col) const;
-    
+    void drawAnalysis() const;
+    void drawReview() const;
 };
 
@@ -0,0 +1,146 @@
+#include "ChessAnalysis.h"
+#include "ChessTT.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+ChessAnalyzer::ChessAnalyzer(int lines, const ThreadPlacement& placement, int cpuIndex)
+    : lineCount(std::max(1, std::min(lines, AnalysisSnapshot::MAX_LINES))), placement(placement), cpuIndex(std::max(0, cpuIndex)) {}
+
+ChessAnalyzer::~ChessAnalyzer() {
+    shutdown();
+}
+
+void ChessAnalyzer::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        abortSearch = true;
+    }
+    wake.notify_one();
+    if (worker.joinable()) worker.join();
+}
+
+void ChessAnalyzer::analyze(const ChessGame& game, PieceColor sideToMove) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = std::make_unique<ChessGame>(game);
+        pendingSide = sideToMove;
+        hasPending = true;
+        abortSearch = true; // interrupt the running search, the worker picks up the new job
+        if (!worker.joinable()) worker = std::thread(&ChessAnalyzer::workerLoop, this);
+    }
+    wake.notify_one();
+}
+
+void ChessAnalyzer::stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    hasPending = false;
+    abortSearch = true;
+}
+
+void ChessAnalyzer::workerLoop() {
+    CpuTopology::placeWorker(cpuIndex, cpuIndex + 1, placement);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return quit || hasPending; });
+        if (quit) break;
+        std::unique_ptr<ChessGame> game = std::move(pending);
+        PieceColor side = pendingSide;
+        hasPending = false;
+        abortSearch = false;
+        lock.unlock();
+        search(*game, side, game->computeHash(side));
+        lock.lock();
+    }
+}
+
+void ChessAnalyzer::extractPV(const ChessGame& game, const Move& first, PieceColor side, AnalysisLine& line) const {
+    ChessGame walk = game;
+    Move move = first;
+    line.pvLength = 0;
+    while (true) {
+        line.pv[line.pvLength++] = packMove(move);
+        walk.applyMove(move);
+        side = (side == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+        if (line.pvLength >= AnalysisLine::MAX_PV || !walk.tt) break;
+
+        TTEntry e;
+        if (!walk.tt->probe(walk.computeHash(side), e) || !e.move) break;
+        std::vector<Move> moves;
+        walk.generatePseudoLegalMoves(side, moves);
+        walk.validateMoves(moves, side);
+        auto it = std::find_if(moves.begin(), moves.end(), [&](const Move& m) { return packMove(m) == e.move; });
+        if (it == moves.end()) break;
+        move = *it;
+    }
+}
+
+void ChessAnalyzer::search(ChessGame& game, PieceColor side, uint64_t key) {
+    game.stopFlag = &abortSearch;
+    game.nodes = 0;
+    const int INF = ChessGame::INF_SCORE;
+    const int sign = (side == PieceColor::WHITE) ? 1 : -1; // converts White-relative scores to the mover's view
+    PieceColor opponent = (side == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+
+    std::vector<Move> roots;
+    game.generatePseudoLegalMoves(side, roots);
+    game.validateMoves(roots, side);
+    if (roots.empty()) {
+        AnalysisSnapshot& snap = snapshots.writeSlot();
+        snap = AnalysisSnapshot{};
+        snap.key = key;
+        snapshots.publish();
+        return;
+    }
+
+    int k = std::min(lineCount, (int)roots.size());
+    std::vector<int> scores(roots.size(), 0);
+    std::vector<int> order(roots.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = (int)i;
+
+    for (int depth = 1; depth <= MAX_DEPTH; ++depth) {
+        // Best lines of the previous iteration first
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return sign * scores[a] > sign * scores[b]; });
+
+        std::vector<int> top; // mover-relative scores of the best k lines so far, descending
+        for (int idx : order) {
+            ChessGame child = game;
+            child.nodes = 0;
+            child.applyMove(roots[idx]);
+            int val;
+            if ((int)top.size() < k) {
+                val = child.minimax(depth - 1, 1, -INF, INF, opponent);
+            }
+            else {
+                // Null-window test against the current k-th line; only moves that beat it get an exact score
+                int kth = sign * top[k - 1];
+                val = (sign > 0) ? child.minimax(depth - 1, 1, kth, kth + 1, opponent) : child.minimax(depth - 1, 1, kth - 1, kth, opponent);
+                if (sign * val > top[k - 1]) {
+                    val = (sign > 0) ? child.minimax(depth - 1, 1, kth, INF, opponent) : child.minimax(depth - 1, 1, -INF, kth, opponent);
+                }
+            }
+            game.nodes += child.nodes;
+            if (abortSearch.load(std::memory_order_relaxed)) return;
+
+            scores[idx] = val;
+            top.insert(std::upper_bound(top.begin(), top.end(), sign * val, std::greater<int>()), sign * val);
+            if ((int)top.size() > k) top.pop_back();
+        }
+
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return sign * scores[a] > sign * scores[b]; });
+        AnalysisSnapshot& snap = snapshots.writeSlot();
+        snap.key = key;
+        snap.depth = depth;
+        snap.nodes = game.nodes;
+        snap.lineCount = k;
+        for (int i = 0; i < k; ++i) {
+            snap.lines[i].score = scores[order[i]];
+            extractPV(game, roots[order[i]], side, snap.lines[i]);
+        }
+        snapshots.publish();
+
+        // A forced mate for the best line will not change with more depth
+        if (std::abs(scores[order[0]]) > ChessGame::MATE_SCORE - 1000) return;
+    }
+}
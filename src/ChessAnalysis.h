@@ -0,0 +1,83 @@
+#pragma once
+#include "Chess.h"
+#include "CpuTopology.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+struct AnalysisLine {
+    static constexpr int MAX_PV = 8;
+    int score = 0;          // White-relative, same scale as ChessGame::minimax
+    int pvLength = 0;
+    uint16_t pv[MAX_PV]{};  // packMove() encoding
+};
+
+struct AnalysisSnapshot {
+    static constexpr int MAX_LINES = 5;
+    uint64_t key = 0;       // position the lines belong to (computeHash of the root)
+    int depth = 0;
+    int lineCount = 0;
+    uint64_t nodes = 0;
+    AnalysisLine lines[MAX_LINES];
+};
+
+// Single-producer / single-consumer triple buffer: the worker fills the back slot and swaps
+// it with the middle one; the UI picks the middle slot up when it is marked fresh. Neither
+// side ever waits on the other.
+class AnalysisSnapshotBuffer {
+public:
+    AnalysisSnapshot& writeSlot() { return slots[back]; }
+    void publish() { back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK; }
+    const AnalysisSnapshot& read() {
+        if (middle.load(std::memory_order_relaxed) & FRESH) front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return slots[front];
+    }
+
+private:
+    static constexpr int FRESH = 4;
+    static constexpr int INDEX_MASK = 3;
+    AnalysisSnapshot slots[3];
+    std::atomic<int> middle{ 1 };
+    int back = 0;  // worker only
+    int front = 2; // UI only
+};
+
+// Infinite multi-PV search of the current position on a worker thread. Restarting on a new
+// position only swaps the job; the thread and the game's transposition table are reused.
+class ChessAnalyzer {
+public:
+    // With placement.pin the worker takes CPU `cpuIndex` of that placement, after the CPUs a
+    // pool of cpuIndex threads would use
+    explicit ChessAnalyzer(int lines = 3, const ThreadPlacement& placement = ThreadPlacement{}, int cpuIndex = 0);
+    ~ChessAnalyzer();
+    ChessAnalyzer(const ChessAnalyzer&) = delete;
+    ChessAnalyzer& operator=(const ChessAnalyzer&) = delete;
+
+    void analyze(const ChessGame& game, PieceColor sideToMove);
+    void stop();
+    void shutdown(); // stops and joins the worker; also done by the destructor
+    const AnalysisSnapshot& latest() const { return snapshots.read(); } // UI thread only
+    int lines() const { return lineCount; }
+
+private:
+    static constexpr int MAX_DEPTH = 32;
+
+    void workerLoop();
+    void search(ChessGame& game, PieceColor side, uint64_t key);
+    void extractPV(const ChessGame& game, const Move& first, PieceColor side, AnalysisLine& line) const;
+
+    int lineCount;
+    ThreadPlacement placement;
+    int cpuIndex;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::unique_ptr<ChessGame> pending;
+    PieceColor pendingSide = PieceColor::WHITE;
+    bool hasPending = false;
+    bool quit = false;
+    std::atomic<bool> abortSearch{ false };
+    mutable AnalysisSnapshotBuffer snapshots;
+};
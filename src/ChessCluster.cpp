@@ -0,0 +1,453 @@
+#include "ChessCluster.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+static double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+std::vector<ClusterJob> ChessCluster::splitRoot(const ChessGame& game, int depth, std::vector<Move>& roots) {
+    PieceColor side = game.sideToMove();
+    PieceColor opponent = (side == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    game.generatePseudoLegalMoves(side, roots);
+    game.validateMoves(roots, side);
+    std::vector<ClusterJob> jobs;
+    for (const auto& m : roots) {
+        ChessGame child = game;
+        child.applyMove(m);
+        ClusterJob job;
+        job.fen = child.toFEN(opponent);
+        job.depth = depth - 1;
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+bool ChessCluster::isFastestMate(int score, PieceColor side) {
+    return (side == PieceColor::WHITE) ? score >= ChessGame::MATE_SCORE - 1 : score <= -(ChessGame::MATE_SCORE - 1);
+}
+
+#if defined(_WIN32)
+
+ChessCluster::ChessCluster(const std::string& addr) : address(addr) {}
+ChessCluster::~ChessCluster() {}
+bool ChessCluster::listen() { return false; }
+bool ChessCluster::spawnLocalWorkers(int) { return false; }
+std::vector<ClusterResult> ChessCluster::run(const std::vector<ClusterJob>& jobs, double, const std::function<bool(const ClusterResult&)>&) {
+    return std::vector<ClusterResult>(jobs.size());
+}
+int ChessCluster::runWorker(const std::string&) { return 1; }
+void ChessCluster::acceptWorkers() {}
+int ChessCluster::dropWorker(size_t) { return -1; }
+void ChessCluster::shutdownWorkers() {}
+
+#else
+
+namespace {
+    // Fills a socket address from "unix:/path" or "tcp:host:port"
+    bool resolve(const std::string& address, sockaddr_storage& sa, socklen_t& len) {
+        memset(&sa, 0, sizeof(sa));
+        if (address.compare(0, 5, "unix:") == 0) {
+            std::string path = address.substr(5);
+            sockaddr_un* un = (sockaddr_un*)&sa;
+            if (path.empty() || path.size() >= sizeof(un->sun_path)) return false;
+            un->sun_family = AF_UNIX;
+            memcpy(un->sun_path, path.c_str(), path.size() + 1);
+            len = sizeof(sockaddr_un);
+            return true;
+        }
+        std::string hostPort = (address.compare(0, 4, "tcp:") == 0) ? address.substr(4) : address;
+        size_t colon = hostPort.rfind(':');
+        if (colon == std::string::npos) return false;
+        std::string host = hostPort.substr(0, colon), port = hostPort.substr(colon + 1);
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* found = nullptr;
+        if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &found) != 0 || !found) return false;
+        memcpy(&sa, found->ai_addr, found->ai_addrlen);
+        len = (socklen_t)found->ai_addrlen;
+        freeaddrinfo(found);
+        return true;
+    }
+
+    bool sendLine(int fd, const std::string& line) {
+        std::string msg = line + "\n";
+        size_t sent = 0;
+        while (sent < msg.size()) {
+            ssize_t n = send(fd, msg.data() + sent, msg.size() - sent, 0);
+            if (n <= 0) return false;
+            sent += (size_t)n;
+        }
+        return true;
+    }
+
+    // Appends what is available to `buffer`; false once the peer has closed the connection
+    bool receive(int fd, std::string& buffer) {
+        char chunk[4096];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, (size_t)n);
+        return true;
+    }
+
+    bool nextLine(std::string& buffer, std::string& line) {
+        size_t eol = buffer.find('\n');
+        if (eol == std::string::npos) return false;
+        line = buffer.substr(0, eol);
+        buffer.erase(0, eol + 1);
+        return true;
+    }
+}
+
+ChessCluster::ChessCluster(const std::string& addr) : address(addr) {
+    signal(SIGPIPE, SIG_IGN); // a worker dying mid-send is handled as a disconnect
+}
+
+ChessCluster::~ChessCluster() {
+    shutdownWorkers();
+    if (listenFd >= 0) close(listenFd);
+    if (address.compare(0, 5, "unix:") == 0) unlink(address.c_str() + 5);
+}
+
+bool ChessCluster::listen() {
+    sockaddr_storage sa;
+    socklen_t len = 0;
+    if (!resolve(address, sa, len)) return false;
+    if (sa.ss_family == AF_UNIX) unlink(((sockaddr_un*)&sa)->sun_path);
+    listenFd = socket(sa.ss_family, SOCK_STREAM, 0);
+    if (listenFd < 0) return false;
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(listenFd, (sockaddr*)&sa, len) != 0 || ::listen(listenFd, 64) != 0) {
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+bool ChessCluster::spawnLocalWorkers(int count) {
+    for (int i = 0; i < count; ++i) {
+        pid_t pid = fork();
+        if (pid < 0) return false;
+        if (pid == 0) {
+            close(listenFd);
+            _exit(runWorker(address));
+        }
+        children.push_back((int)pid);
+    }
+    return true;
+}
+
+void ChessCluster::acceptWorkers() {
+    while (true) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) return;
+        Worker w;
+        w.fd = fd;
+        w.id = nextWorkerId++;
+        workers.push_back(w);
+    }
+}
+
+int ChessCluster::dropWorker(size_t index) {
+    int job = workers[index].job;
+    close(workers[index].fd);
+    workers.erase(workers.begin() + index);
+    return job;
+}
+
+void ChessCluster::shutdownWorkers() {
+    for (auto& w : workers) {
+        sendLine(w.fd, "QUIT");
+        close(w.fd);
+    }
+    workers.clear();
+    for (int pid : children) waitpid((pid_t)pid, nullptr, 0);
+    children.clear();
+}
+
+std::vector<ClusterResult> ChessCluster::run(const std::vector<ClusterJob>& jobs, double timeLimit,
+    const std::function<bool(const ClusterResult&)>& enough) {
+    std::vector<ClusterResult> results(jobs.size());
+    std::vector<std::chrono::steady_clock::time_point> started(jobs.size());
+    std::deque<int> queue;
+    for (int i = 0; i < (int)jobs.size(); ++i) queue.push_back(i);
+    size_t outstanding = jobs.size();
+    bool stopping = false;
+    auto t0 = std::chrono::steady_clock::now();
+    auto lastWorkerSeen = t0;
+
+    // Cancellation: queued jobs are dropped, running ones are told to stop and acknowledge
+    auto stopAll = [&]() {
+        stopping = true;
+        outstanding -= queue.size();
+        queue.clear();
+        for (auto& w : workers) {
+            if (w.job >= 0 && !w.cancelSent) {
+                sendLine(w.fd, "CANCEL " + std::to_string(w.job));
+                w.cancelSent = true;
+            }
+        }
+    };
+
+    while (outstanding > 0) {
+        if (!stopping && timeLimit > 0 && secondsSince(t0) >= timeLimit) stopAll();
+
+        // Dynamic load balancing: every idle worker takes the next queued job
+        for (auto& w : workers) {
+            if (w.job >= 0 || queue.empty()) continue;
+            int j = queue.front();
+            queue.pop_front();
+            const ClusterJob& job = jobs[j];
+            if (sendLine(w.fd, "JOB " + std::to_string(j) + (job.pickMove ? " root " : " node ") + std::to_string(job.depth) + " " + job.fen)) {
+                w.job = j;
+                w.cancelSent = false;
+                started[j] = std::chrono::steady_clock::now();
+            }
+            else queue.push_front(j);
+        }
+
+        if (!workers.empty()) lastWorkerSeen = std::chrono::steady_clock::now();
+        else if (secondsSince(lastWorkerSeen) > 30.0) {
+            fprintf(stderr, "no workers connected for 30s, giving up\n");
+            break;
+        }
+
+        std::vector<pollfd> fds;
+        fds.push_back(pollfd{ listenFd, POLLIN, 0 });
+        for (auto& w : workers) fds.push_back(pollfd{ w.fd, POLLIN, 0 });
+        if (poll(fds.data(), fds.size(), 50) < 0) continue;
+        if (fds[0].revents & POLLIN) acceptWorkers();
+
+        // Walk backwards so dropped workers do not shift the ones still to visit
+        for (size_t i = fds.size() - 1; i >= 1; --i) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            size_t wi = i - 1;
+            if (!receive(workers[wi].fd, workers[wi].input)) {
+                // A lost worker's job goes back to the front of the queue
+                int job = dropWorker(wi);
+                if (job >= 0) {
+                    if (stopping) --outstanding;
+                    else queue.push_front(job);
+                }
+                continue;
+            }
+            Worker& w = workers[wi];
+            std::string line;
+            while (nextLine(w.input, line)) {
+                std::istringstream in(line);
+                std::string kind;
+                int id = -1;
+                in >> kind >> id;
+                if (id < 0 || id != w.job) continue; // HELLO, or a reply for a job already settled
+                if (kind == "RESULT") {
+                    ClusterResult& r = results[id];
+                    std::string move;
+                    in >> r.score >> r.nodes >> move;
+                    r.done = true;
+                    r.bestMove = (move == "-") ? "" : move;
+                    r.worker = w.id;
+                    r.seconds = secondsSince(started[id]);
+                    ++w.jobsDone;
+                    w.job = -1;
+                    --outstanding;
+                    if (!stopping && enough && enough(r)) stopAll();
+                }
+                else if (kind == "CANCELLED") {
+                    w.job = -1;
+                    --outstanding;
+                }
+            }
+        }
+    }
+    return results;
+}
+
+int ChessCluster::runWorker(const std::string& address) {
+    signal(SIGPIPE, SIG_IGN);
+    sockaddr_storage sa;
+    socklen_t len = 0;
+    if (!resolve(address, sa, len)) { fprintf(stderr, "bad address %s\n", address.c_str()); return 1; }
+    int fd = -1;
+    for (int attempt = 0; attempt < 50 && fd < 0; ++attempt) {
+        fd = socket(sa.ss_family, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (sockaddr*)&sa, len) != 0) {
+            close(fd);
+            fd = -1;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    if (fd < 0) { fprintf(stderr, "cannot reach coordinator at %s\n", address.c_str()); return 1; }
+    sendLine(fd, "HELLO " + std::to_string((long long)getpid()));
+
+    // The template game owns the worker's transposition table; jobs run on copies that share it
+    ChessGame base;
+    base.init(800, 720);
+    std::atomic<bool> abortSearch{ false };
+    std::atomic<int> current{ -1 };
+    std::mutex sendMutex;
+    std::thread search;
+
+    std::string input, line;
+    bool running = true;
+    while (running && receive(fd, input)) {
+        while (running && nextLine(input, line)) {
+            std::istringstream in(line);
+            std::string kind;
+            in >> kind;
+            if (kind == "QUIT") { running = false; break; }
+            if (kind == "CANCEL") {
+                int id = -1;
+                in >> id;
+                if (id == current.load()) abortSearch = true;
+                continue;
+            }
+            if (kind != "JOB") continue;
+
+            int id = -1, depth = 0;
+            std::string mode, fen;
+            in >> id >> mode >> depth;
+            std::getline(in >> std::ws, fen);
+            if (search.joinable()) search.join();
+            abortSearch = false;
+            current = id;
+            search = std::thread([&, id, depth, mode, fen]() {
+                ChessGame game = base;
+                game.loadFEN(fen);
+                game.stopFlag = &abortSearch;
+                game.nodes = 0;
+                PieceColor side = game.sideToMove();
+                int score = 0;
+                std::string best = "-";
+                if (mode == "root") {
+                    Move m = game.searchBestMove(side, depth, &score);
+                    if (m.fromRow >= 0) best = moveToString(m);
+                    else score = game.isInCheck(side) ? (side == PieceColor::WHITE ? -ChessGame::MATE_SCORE : ChessGame::MATE_SCORE) : 0;
+                }
+                else {
+                    score = game.minimax(depth, 1, -ChessGame::INF_SCORE, ChessGame::INF_SCORE, side);
+                }
+                std::lock_guard<std::mutex> lock(sendMutex);
+                if (abortSearch) sendLine(fd, "CANCELLED " + std::to_string(id));
+                else sendLine(fd, "RESULT " + std::to_string(id) + " " + std::to_string(score) + " " + std::to_string(game.nodes) + " " + best);
+                current = -1;
+            });
+        }
+    }
+    abortSearch = true;
+    if (search.joinable()) search.join();
+    close(fd);
+    return 0;
+}
+
+#endif
+
+int RunClusterTool(int argc, char** argv) {
+    // argv[0] is "--cluster" or "--cluster-worker"
+    if (strcmp(argv[0], "--cluster-worker") == 0) {
+        if (argc < 2) { printf("usage: --cluster-worker <unix:/path | tcp:host:port>\n"); return 2; }
+        return ChessCluster::runWorker(argv[1]);
+    }
+
+    std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    std::string batch;
+    std::string address;
+    int depth = 4, workerCount = 2;
+    double moveTime = 0.0;
+    for (int i = 1; i + 1 < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--fen") fen = argv[++i];
+        else if (arg == "--batch") batch = argv[++i];
+        else if (arg == "--depth") depth = atoi(argv[++i]);
+        else if (arg == "--workers") workerCount = atoi(argv[++i]);
+        else if (arg == "--listen") address = argv[++i];
+        else if (arg == "--movetime") moveTime = atof(argv[++i]) / 1000.0;
+    }
+#if defined(_WIN32)
+    printf("cluster mode needs POSIX sockets\n");
+    return 1;
+#else
+    if (address.empty()) address = "unix:/tmp/sgm-cluster-" + std::to_string((long long)getpid()) + ".sock";
+#endif
+
+    ChessCluster cluster(address);
+    if (!cluster.listen()) { printf("cannot listen on %s\n", address.c_str()); return 1; }
+    if (workerCount > 0) cluster.spawnLocalWorkers(workerCount);
+    else printf("waiting for workers: --cluster-worker %s\n", address.c_str());
+
+    std::vector<ClusterJob> jobs;
+    std::vector<Move> roots;
+    std::vector<std::string> fens;
+    ChessGame game;
+    if (!batch.empty()) {
+        std::ifstream in(batch);
+        for (std::string line; std::getline(in, line);) {
+            if (line.empty() || line[0] == '#') continue;
+            ClusterJob job;
+            job.fen = line;
+            job.depth = depth;
+            job.pickMove = true;
+            jobs.push_back(job);
+            fens.push_back(line);
+        }
+    }
+    else {
+        if (!game.loadFEN(fen)) { printf("invalid FEN: %s\n", fen.c_str()); return 2; }
+        jobs = ChessCluster::splitRoot(game, depth, roots);
+    }
+    if (jobs.empty()) { printf("nothing to search\n"); return 1; }
+
+    PieceColor side = game.sideToMove();
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<ClusterResult> results = cluster.run(jobs, moveTime, [&](const ClusterResult& r) {
+        return batch.empty() && ChessCluster::isFastestMate(r.score, side);
+    });
+    double seconds = secondsSince(t0);
+
+    uint64_t nodes = 0;
+    int done = 0, best = -1;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ClusterResult& r = results[i];
+        nodes += r.nodes;
+        if (!r.done) {
+            printf("%-8s cancelled\n", batch.empty() ? moveToString(roots[i]).c_str() : fens[i].c_str());
+            continue;
+        }
+        ++done;
+        if (batch.empty()) {
+            bool better = best < 0 || (side == PieceColor::WHITE ? r.score > results[best].score : r.score < results[best].score);
+            if (better) best = (int)i;
+            printf("%-8s %8s %10llu nodes  worker %d  %6.2fs\n", moveToString(roots[i]).c_str(), formatScore(r.score).c_str(),
+                (unsigned long long)r.nodes, r.worker, r.seconds);
+        }
+        else {
+            printf("%s  bestmove %s  %s  worker %d\n", fens[i].c_str(), r.bestMove.empty() ? "(none)" : r.bestMove.c_str(),
+                formatScore(r.score).c_str(), r.worker);
+        }
+    }
+    if (best >= 0) printf("best %s %s\n", moveToString(roots[best]).c_str(), formatScore(results[best].score).c_str());
+    printf("%d/%zu jobs, %d workers, %llu nodes in %.2fs, %.0f nodes/s\n", done, results.size(), cluster.workerCount(),
+        (unsigned long long)nodes, seconds, seconds > 0 ? nodes / seconds : 0.0);
+    return 0;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "Chess.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// One unit of work for a worker process: a position searched to a fixed depth. Root-split
+// jobs ("node") score the position after a root move; batch jobs ("root") pick a best move.
+struct ClusterJob {
+    std::string fen;
+    int depth = 1;
+    bool pickMove = false;
+};
+
+struct ClusterResult {
+    bool done = false;      // false when cancelled or never started
+    int score = 0;          // White-relative, as in ChessGame
+    uint64_t nodes = 0;
+    std::string bestMove;   // batch jobs only
+    int worker = -1;
+    double seconds = 0.0;
+};
+
+// Coordinator and worker for searching across processes (and hosts). Workers connect to the
+// coordinator over a Unix or TCP stream socket and exchange one-line text messages:
+//   coordinator -> worker: JOB <id> <node|root> <depth> <fen> / CANCEL <id> / QUIT
+//   worker -> coordinator: HELLO <pid> / RESULT <id> <score> <nodes> <move|-> / CANCELLED <id>
+// Each worker holds one job at a time, so faster workers simply take more of the queue.
+class ChessCluster {
+public:
+    // "unix:/path" or "tcp:host:port"
+    explicit ChessCluster(const std::string& address);
+    ~ChessCluster();
+    ChessCluster(const ChessCluster&) = delete;
+    ChessCluster& operator=(const ChessCluster&) = delete;
+
+    bool listen();
+    // Starts `count` worker processes on this machine that connect back to the coordinator
+    bool spawnLocalWorkers(int count);
+    // Runs every job; stops early (cancelling outstanding work) once `timeLimit` seconds pass
+    // or `enough` returns true for a finished result
+    std::vector<ClusterResult> run(const std::vector<ClusterJob>& jobs, double timeLimit = 0.0,
+        const std::function<bool(const ClusterResult&)>& enough = nullptr);
+    int workerCount() const { return (int)workers.size(); }
+
+    // Worker process main loop; returns when the coordinator says QUIT or disconnects
+    static int runWorker(const std::string& address);
+    // Root-split jobs for every legal move of `game`; each child is searched to depth - 1
+    static std::vector<ClusterJob> splitRoot(const ChessGame& game, int depth, std::vector<Move>& roots);
+    // True when a root move's score is a mate in one for `side`, which nothing can beat
+    static bool isFastestMate(int score, PieceColor side);
+
+private:
+    struct Worker {
+        int fd = -1;
+        int id = 0;
+        int job = -1;        // job in flight, -1 when idle
+        bool cancelSent = false;
+        int jobsDone = 0;
+        std::string input;
+    };
+    void acceptWorkers();
+    int dropWorker(size_t index); // returns the job it held, or -1
+    void shutdownWorkers();
+
+    std::string address;
+    int listenFd = -1;
+    int nextWorkerId = 0;
+    std::vector<Worker> workers;
+    std::vector<int> children;
+};
+
+// Console front end: --cluster [--fen FEN | --batch FILE] [--depth N] [--workers K] [--listen ADDR] [--movetime MS]
+//                    --cluster-worker ADDR
+int RunClusterTool(int argc, char** argv);
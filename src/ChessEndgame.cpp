@@ -0,0 +1,172 @@
+#include "ChessEndgame.h"
+#include "ChessTables.h"
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+// Material key with the colors swapped (White's five counts are the low 20 bits)
+constexpr uint64_t mirrorKey(uint64_t key) {
+    return ((key & 0xFFFFFULL) << 20) | (key >> 20);
+}
+
+bool lightSquare(int square) { return ((square / 8 + square % 8) & 1) == 0; }
+
+int kingDistance(int a, int b) { return ChessTables::kTables.distance[a][b]; }
+
+// Distance to the nearer corner of the given square color (KBNvK can only mate there)
+int cornerDistance(int square, bool light) {
+    return light ? std::min(kingDistance(square, 0), kingDistance(square, 63))
+                 : std::min(kingDistance(square, 7), kingDistance(square, 56));
+}
+
+// Squares the bare king can reach without crossing the strong side's attacks: the box the
+// rook or queen has fenced it into, which has to shrink for the mate to make progress
+int kingBox(const uint8_t* attacked, int king) {
+    bool seen[64] = {};
+    int stack[64], top = 0, size = 0;
+    stack[top++] = king;
+    seen[king] = true;
+    while (top > 0) {
+        int sq = stack[--top];
+        ++size;
+        for (int dr = -1; dr <= 1; ++dr) {
+            for (int dc = -1; dc <= 1; ++dc) {
+                int r = sq / 8 + dr, c = sq % 8 + dc;
+                if (r < 0 || r > 7 || c < 0 || c > 7) continue;
+                int to = r * 8 + c;
+                if (seen[to] || attacked[to]) continue;
+                seen[to] = true;
+                stack[top++] = to;
+            }
+        }
+    }
+    return size;
+}
+
+}
+
+// Sorted by key at compile time, so probing needs no setup
+constexpr std::array<ChessEndgames::Recognizer, ChessEndgames::RECOGNIZER_COUNT> ChessEndgames::buildRecognizers() {
+    struct Known { const char* code; Recognize fn; };
+    constexpr Known known[] = {
+        { "KvK", draw }, { "KBvK", draw }, { "KNvK", draw }, { "KNNvK", knightsDraw },
+        { "KBvKB", bishopsDraw },
+        { "KQvK", mopUp }, { "KRvK", mopUp }, { "KBNvK", mopUp }, { "KBBvK", mopUp },
+    };
+    std::array<Recognizer, RECOGNIZER_COUNT> t{};
+    int n = 0;
+    for (const Known& k : known) {
+        uint64_t key = signature(k.code);
+        t[n++] = Recognizer{ key, PieceColor::WHITE, k.fn };
+        if (mirrorKey(key) != key) t[n++] = Recognizer{ mirrorKey(key), PieceColor::BLACK, k.fn };
+    }
+    for (int i = 1; i < n; ++i) {
+        for (int j = i; j > 0 && t[j].key < t[j - 1].key; --j) {
+            Recognizer tmp = t[j]; t[j] = t[j - 1]; t[j - 1] = tmp;
+        }
+    }
+    return t;
+}
+
+int ChessEndgames::pieces(const ChessGame& game, PieceColor color, int* squares, PieceType* types, int maxCount) {
+    int n = 0;
+    for (int sq = 0; sq < 64 && n < maxCount; ++sq) {
+        const Piece& p = game.board[sq / 8][sq % 8];
+        if (p.color != color || p.type == PieceType::KING) continue;
+        squares[n] = sq;
+        types[n] = p.type;
+        ++n;
+    }
+    return n;
+}
+
+bool ChessEndgames::probe(const ChessGame& game, PieceColor sideToMove, EndgameScore& out) {
+    static constexpr std::array<Recognizer, RECOGNIZER_COUNT> table = buildRecognizers();
+    auto it = std::lower_bound(table.begin(), table.end(), game.materialKey,
+        [](const Recognizer& r, uint64_t key) { return r.key < key; });
+    if (it == table.end() || it->key != game.materialKey) return false;
+    return it->fn(game, it->strong, sideToMove, out);
+}
+
+bool ChessEndgames::isDeadDraw(const ChessGame& game) {
+    constexpr uint64_t loneKnight[] = { signature("KNvK"), signature("KvKN") };
+    constexpr uint64_t bishopFields = signature("KBvKB") * 0xF;
+    uint64_t key = game.materialKey;
+    if (std::find(std::begin(loneKnight), std::end(loneKnight), key) != std::end(loneKnight)) return true;
+    if (key & ~bishopFields) return false;
+
+    // Bare kings or bishops only: dead if every bishop stands on one square color
+    int squares[32];
+    PieceType types[32];
+    int count = pieces(game, PieceColor::WHITE, squares, types, 16);
+    count += pieces(game, PieceColor::BLACK, squares + count, types + count, 16);
+    for (int i = 1; i < count; ++i) {
+        if (lightSquare(squares[i]) != lightSquare(squares[0])) return false;
+    }
+    return true;
+}
+
+bool ChessEndgames::draw(const ChessGame&, PieceColor, PieceColor, EndgameScore& out) {
+    out = EndgameScore{ 0, TTBound::EXACT };
+    return true;
+}
+
+// KNNvK: no forced mate, but the defender can still walk into one, so a position that is
+// already check, or where the knights have a mate in one, is left to the search
+bool ChessEndgames::knightsDraw(const ChessGame& game, PieceColor strong, PieceColor toMove, EndgameScore& out) {
+    if (toMove != strong) {
+        if (game.isInCheck(toMove)) return false;
+        return draw(game, strong, toMove, out);
+    }
+    PieceColor weak = (strong == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    std::vector<Move> moves;
+    game.generatePseudoLegalMoves(strong, moves);
+    ChessGame::SavedState saved = game.saveState();
+    ChessGame* trial = const_cast<ChessGame*>(&game); // trial moves, undone before returning
+    for (const Move& move : moves) {
+        trial->applyMove(move);
+        bool mate = !game.isInCheck(strong) && game.isCheckmate(weak);
+        trial->restoreState(saved);
+        if (mate) return false;
+    }
+    return draw(game, strong, toMove, out);
+}
+
+// KBvKB with both bishops on one square color
+bool ChessEndgames::bishopsDraw(const ChessGame& game, PieceColor strong, PieceColor toMove, EndgameScore& out) {
+    if (!isDeadDraw(game)) return false;
+    return draw(game, strong, toMove, out);
+}
+
+// Basic mates: drive the bare king to the edge (the bishop's corner for KBNvK) and bring the
+// kings together. With the strong side to move the ending is always won, so the score is also
+// a bound; with the defender to move it is only an evaluation, and none at all if a piece hangs.
+bool ChessEndgames::mopUp(const ChessGame& game, PieceColor strong, PieceColor toMove, EndgameScore& out) {
+    PieceColor weak = (strong == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    int s = ChessGame::colorIndex(strong), w = ChessGame::colorIndex(weak);
+    int strongKing = game.kingSquare[s], weakKing = game.kingSquare[w];
+    if (strongKing < 0 || weakKing < 0) return false;
+
+    int squares[3];
+    PieceType types[3];
+    int count = pieces(game, strong, squares, types, 3);
+    int bishopSquares[2], bishops = 0, material = 0;
+    for (int i = 0; i < count; ++i) {
+        if (toMove == weak && game.attackCount[w][squares[i]] && !game.attackCount[s][squares[i]]) return false;
+        if (types[i] == PieceType::BISHOP) bishopSquares[bishops++] = squares[i];
+        material += game.getPieceValue(types[i]);
+    }
+    if (bishops == 2 && lightSquare(bishopSquares[0]) == lightSquare(bishopSquares[1])) return false; // cannot mate
+
+    int edge = ChessTables::kTables.centerDistance[weakKing];
+    if (bishops == 1 && count == 2) edge = 2 * (7 - cornerDistance(weakKing, lightSquare(bishopSquares[0])));
+
+    int score = KNOWN_WIN + material + 10 * edge + 4 * (7 - kingDistance(strongKing, weakKing))
+        + 2 * (64 - kingBox(game.attackCount[s].data(), weakKing));
+    bool white = (strong == PieceColor::WHITE);
+    out.score = white ? score : -score;
+    out.bound = (toMove != strong) ? TTBound::NONE : white ? TTBound::LOWER : TTBound::UPPER;
+    return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "Chess.h"
+#include "ChessTT.h"
+#include <array>
+#include <cstdint>
+
+struct EndgameScore {
+    int score = 0;                 // White-relative, as in ChessGame
+    TTBound bound = TTBound::NONE; // EXACT/LOWER/UPPER may cut the search; NONE is a leaf evaluation only
+};
+
+// Endings whose outcome follows from the material alone (KvK, KBvK, KNNvK, KRvK, ...). Each
+// recognizer is keyed by ChessGame::materialKey, so probing an unrelated position costs one
+// search of a small sorted table.
+class ChessEndgames {
+public:
+    // Known draw or mop-up score for the position; false when no recognizer applies
+    static bool probe(const ChessGame& game, PieceColor sideToMove, EndgameScore& out);
+    // Neither side can ever mate: bare kings, a lone minor piece, or bishops all on one square color
+    static bool isDeadDraw(const ChessGame& game);
+    // Material key for a code like "KRvK"; the side before the 'v' is White
+    static constexpr uint64_t signature(const char* code) {
+        uint64_t key = 0;
+        PieceColor color = PieceColor::WHITE;
+        for (; *code; ++code) {
+            PieceType type = PieceType::EMPTY; // kings are not counted
+            switch (*code) {
+            case 'v': color = PieceColor::BLACK; break;
+            case 'Q': type = PieceType::QUEEN; break;
+            case 'R': type = PieceType::ROOK; break;
+            case 'B': type = PieceType::BISHOP; break;
+            case 'N': type = PieceType::KNIGHT; break;
+            case 'P': type = PieceType::PAWN; break;
+            default: break;
+            }
+            key += ChessGame::materialUnit(Piece{ type, color });
+        }
+        return key;
+    }
+
+    // Base of won-ending scores: above any material balance, far below mate scores
+    static constexpr int KNOWN_WIN = 10000;
+
+private:
+    using Recognize = bool (*)(const ChessGame& game, PieceColor strong, PieceColor toMove, EndgameScore& out);
+    struct Recognizer {
+        uint64_t key;
+        PieceColor strong; // side with the extra material; White for symmetric signatures
+        Recognize fn;
+    };
+    static constexpr int RECOGNIZER_COUNT = 16; // both colorings of every asymmetric signature
+    static constexpr std::array<Recognizer, RECOGNIZER_COUNT> buildRecognizers();
+
+    static bool draw(const ChessGame& game, PieceColor strong, PieceColor toMove, EndgameScore& out);
+    static bool knightsDraw(const ChessGame& game, PieceColor strong, PieceColor toMove, EndgameScore& out);
+    static bool bishopsDraw(const ChessGame& game, PieceColor strong, PieceColor toMove, EndgameScore& out);
+    static bool mopUp(const ChessGame& game, PieceColor strong, PieceColor toMove, EndgameScore& out);
+    // Squares and types of one color's non-king pieces
+    static int pieces(const ChessGame& game, PieceColor color, int* squares, PieceType* types, int maxCount);
+};
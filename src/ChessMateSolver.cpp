@@ -0,0 +1,155 @@
+#include "ChessMateSolver.h"
+#include <algorithm>
+
+MateSolver::MateSolver(size_t megabytes) {
+    size_t wanted = megabytes * 1024 * 1024 / (sizeof(Entry) * BUCKET_SIZE);
+    bucketCount = 1;
+    while (bucketCount * 2 <= wanted) bucketCount *= 2;
+    table.reset(new Entry[bucketCount * BUCKET_SIZE]);
+}
+
+void MateSolver::clear() {
+    std::fill(table.get(), table.get() + bucketCount * BUCKET_SIZE, Entry{});
+}
+
+uint64_t MateSolver::nodeKey(const ChessGame& pos, PieceColor mover, int pliesLeft) const {
+    // Results depend on the remaining depth, so it is part of the key
+    return pos.computeHash(mover) ^ ((uint64_t)(pliesLeft + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+bool MateSolver::lookup(uint64_t key, uint32_t& phi, uint32_t& delta) const {
+    const Entry* bucket = &table[(key & (bucketCount - 1)) * BUCKET_SIZE];
+    for (int i = 0; i < BUCKET_SIZE; ++i) {
+        if (bucket[i].key == key) { phi = bucket[i].phi; delta = bucket[i].delta; return true; }
+    }
+    return false;
+}
+
+void MateSolver::save(uint64_t key, uint32_t phi, uint32_t delta) {
+    Entry* bucket = &table[(key & (bucketCount - 1)) * BUCKET_SIZE];
+    // Same key, else an empty slot, else the entry with the least work (smallest phi + delta)
+    Entry* victim = &bucket[0];
+    for (int i = 0; i < BUCKET_SIZE; ++i) {
+        if (bucket[i].key == key || bucket[i].key == 0) { victim = &bucket[i]; break; }
+        if ((uint64_t)bucket[i].phi + bucket[i].delta < (uint64_t)victim->phi + victim->delta) victim = &bucket[i];
+    }
+    victim->key = key;
+    victim->phi = phi;
+    victim->delta = delta;
+}
+
+void MateSolver::legalMoves(ChessGame& pos, PieceColor mover, std::vector<Move>& moves) const {
+    pos.generatePseudoLegalMoves(mover, moves);
+    pos.validateMoves(moves, mover);
+}
+
+void MateSolver::mid(ChessGame& pos, PieceColor mover, int pliesLeft, uint32_t thPhi, uint32_t thDelta) {
+    if (maxNodes && nodes >= maxNodes) { outOfBudget = true; return; }
+    ++nodes;
+
+    uint64_t key = nodeKey(pos, mover, pliesLeft);
+    bool attackerToMove = (mover == attacker);
+    std::vector<Move> moves;
+    legalMoves(pos, mover, moves);
+
+    // Terminal nodes: mate, stalemate (a defender success) or the attacker out of moves
+    if (moves.empty() || pliesLeft == 0) {
+        bool moverWins = moves.empty() ? (!pos.isInCheck(mover) && !attackerToMove) : !attackerToMove;
+        save(key, moverWins ? 0 : INF, moverWins ? INF : 0);
+        return;
+    }
+
+    PieceColor opponent = (mover == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    ChessGame::SavedState undo = pos.saveState();
+    std::vector<uint64_t> childKeys(moves.size());
+    for (size_t i = 0; i < moves.size(); ++i) {
+        pos.applyMove(moves[i]);
+        childKeys[i] = nodeKey(pos, opponent, pliesLeft - 1);
+        pos.restoreState(undo);
+    }
+
+    while (true) {
+        // phi(n) = min delta(child), delta(n) = sum phi(child)
+        uint32_t phi = INF, delta = 0, delta2 = INF, bestPhi = 0;
+        size_t best = 0;
+        for (size_t i = 0; i < moves.size(); ++i) {
+            uint32_t cPhi = 1, cDelta = 1;
+            lookup(childKeys[i], cPhi, cDelta);
+            delta = std::min<uint32_t>(INF, delta + cPhi);
+            if (cDelta < phi) { delta2 = phi; phi = cDelta; best = i; bestPhi = cPhi; }
+            else if (cDelta < delta2) delta2 = cDelta;
+        }
+        if (phi >= thPhi || delta >= thDelta || outOfBudget) {
+            if (!outOfBudget) save(key, phi, delta);
+            return;
+        }
+
+        int64_t childThPhi = (int64_t)thDelta - delta + bestPhi;
+        uint32_t childThDelta = std::min<uint32_t>(thPhi, delta2 == INF ? INF : delta2 + 1);
+        pos.applyMove(moves[best]);
+        mid(pos, opponent, pliesLeft - 1, (uint32_t)std::min<int64_t>(childThPhi, INF), childThDelta);
+        pos.restoreState(undo);
+    }
+}
+
+void MateSolver::extractLine(ChessGame pos, PieceColor mover, int pliesLeft, std::vector<Move>& line) {
+    while (pliesLeft > 0) {
+        std::vector<Move> moves;
+        legalMoves(pos, mover, moves);
+        PieceColor opponent = (mover == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+        // Follow a child the side to move loses in (the attacker's proof or the defender's refuted reply)
+        const Move* next = nullptr;
+        ChessGame::SavedState undo = pos.saveState();
+        for (const auto& m : moves) {
+            pos.applyMove(m);
+            uint32_t phi = 1, delta = 1;
+            bool known = lookup(nodeKey(pos, opponent, pliesLeft - 1), phi, delta);
+            pos.restoreState(undo);
+            if (known && delta == 0 && mover == attacker) { next = &m; break; }
+            if (known && phi == 0 && mover != attacker) { next = &m; break; }
+        }
+        if (!next) return;
+        line.push_back(*next);
+        pos.applyMove(*next);
+        mover = opponent;
+        --pliesLeft;
+    }
+}
+
+MateResult MateSolver::solveMateIn(const ChessGame& game, PieceColor side, int moves, uint64_t nodeBudget) {
+    MateResult result;
+    ChessGame pos = game;
+    attacker = side;
+    nodes = 0;
+    maxNodes = nodeBudget;
+    outOfBudget = false;
+
+    int plies = moves * 2 - 1;
+    mid(pos, side, plies, INF, INF);
+    result.nodes = nodes;
+    result.exhausted = outOfBudget;
+
+    uint32_t phi = INF, delta = INF;
+    if (!outOfBudget && lookup(nodeKey(pos, side, plies), phi, delta) && phi == 0) {
+        result.found = true;
+        result.mateIn = moves;
+        extractLine(pos, side, plies, result.line);
+        result.found = !result.line.empty();
+    }
+    return result;
+}
+
+MateResult MateSolver::findMate(const ChessGame& game, PieceColor side, int maxMoves, uint64_t nodeBudget) {
+    MateResult result;
+    uint64_t used = 0;
+    for (int n = 1; n <= maxMoves; ++n) {
+        if (nodeBudget && used >= nodeBudget) break;
+        uint64_t left = nodeBudget ? nodeBudget - used : 0;
+        MateResult r = solveMateIn(game, side, n, left);
+        used += r.nodes;
+        r.nodes = used;
+        if (r.found || r.exhausted) return r;
+        result = r;
+    }
+    return result;
+}
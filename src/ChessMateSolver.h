@@ -0,0 +1,51 @@
+#pragma once
+#include "Chess.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct MateResult {
+    bool found = false;
+    bool exhausted = false;  // node budget ran out before the question was settled
+    int mateIn = 0;          // full moves for the attacker
+    std::vector<Move> line;  // attacker's first move first
+    uint64_t nodes = 0;
+};
+
+// Depth-first proof-number (df-pn) search for forced mates. Results live in the solver's own
+// bucketed hash table of (phi, delta) pairs, so memory use is fixed by the constructor and
+// the table can be reused across queries on related positions.
+class MateSolver {
+public:
+    explicit MateSolver(size_t megabytes = 8);
+
+    // Proves or disproves a mate for the side to move in at most `moves` moves.
+    MateResult solveMateIn(const ChessGame& game, PieceColor attacker, int moves, uint64_t maxNodes = 0);
+    // Shortest mate up to `maxMoves`, tried in increasing length. The node budget is shared.
+    MateResult findMate(const ChessGame& game, PieceColor attacker, int maxMoves, uint64_t maxNodes = 0);
+    void clear();
+
+private:
+    static constexpr uint32_t INF = 1u << 30;
+    static constexpr int BUCKET_SIZE = 4;
+
+    struct Entry {
+        uint64_t key = 0;
+        uint32_t phi = 0;   // proof number for the side to move at the node
+        uint32_t delta = 0; // disproof number for the side to move
+    };
+
+    void mid(ChessGame& pos, PieceColor mover, int pliesLeft, uint32_t thPhi, uint32_t thDelta);
+    void legalMoves(ChessGame& pos, PieceColor mover, std::vector<Move>& moves) const;
+    uint64_t nodeKey(const ChessGame& pos, PieceColor mover, int pliesLeft) const;
+    bool lookup(uint64_t key, uint32_t& phi, uint32_t& delta) const;
+    void save(uint64_t key, uint32_t phi, uint32_t delta);
+    void extractLine(ChessGame pos, PieceColor mover, int pliesLeft, std::vector<Move>& line);
+
+    std::unique_ptr<Entry[]> table;
+    size_t bucketCount = 0;
+    PieceColor attacker = PieceColor::WHITE;
+    uint64_t nodes = 0;
+    uint64_t maxNodes = 0;
+    bool outOfBudget = false;
+};
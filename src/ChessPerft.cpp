@@ -0,0 +1,230 @@
+#include "ChessPerft.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+ChessPerft::ChessPerft(const PerftOptions& opts) : options(opts) {
+    if (options.threads < 1) options.threads = 1;
+    if (options.hashMB > 0 && !options.stats) {
+        size_t wanted = options.hashMB * 1024 * 1024 / sizeof(Slot);
+        slotCount = 1;
+        while (slotCount * 2 <= wanted) slotCount *= 2;
+        table.reset(new Slot[slotCount]);
+    }
+}
+
+static uint64_t depthKey(int depth) {
+    return (uint64_t)depth * 0x9E3779B97F4A7C15ULL;
+}
+
+bool ChessPerft::probe(uint64_t key, uint64_t& nodes) const {
+    if (!table) return false;
+    const Slot& s = table[key & (slotCount - 1)];
+    uint64_t n = s.nodes.load(std::memory_order_relaxed);
+    if ((s.check.load(std::memory_order_relaxed) ^ n) != key) return false;
+    nodes = n;
+    return true;
+}
+
+void ChessPerft::store(uint64_t key, uint64_t nodes) {
+    if (!table) return;
+    Slot& s = table[key & (slotCount - 1)];
+    s.nodes.store(nodes, std::memory_order_relaxed);
+    s.check.store(key ^ nodes, std::memory_order_relaxed);
+}
+
+uint64_t ChessPerft::count(ChessGame& pos, PieceColor side, int depth) {
+    std::vector<Move> moves;
+    pos.generatePseudoLegalMoves(side, moves);
+    pos.validateMoves(moves, side);
+    if (depth == 1) return moves.size(); // bulk counting: leaves are never made
+
+    uint64_t key = pos.computeHash(side) ^ depthKey(depth);
+    uint64_t nodes = 0;
+    if (probe(key, nodes)) return nodes;
+
+    PieceColor opponent = (side == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    ChessGame::SavedState saved = pos.saveState();
+    for (const auto& move : moves) {
+        pos.applyMove(move);
+        nodes += count(pos, opponent, depth - 1);
+        pos.restoreState(saved);
+    }
+    store(key, nodes);
+    return nodes;
+}
+
+void ChessPerft::countStats(ChessGame& pos, PieceColor side, int depth, PerftStats& stats) {
+    std::vector<Move> moves;
+    pos.generatePseudoLegalMoves(side, moves);
+    pos.validateMoves(moves, side);
+
+    PieceColor opponent = (side == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    ChessGame::SavedState saved = pos.saveState();
+    for (const auto& move : moves) {
+        if (depth == 1) {
+            tallyLeaf(pos, move, opponent, stats);
+            continue;
+        }
+        pos.applyMove(move);
+        countStats(pos, opponent, depth - 1, stats);
+        pos.restoreState(saved);
+    }
+}
+
+void ChessPerft::tallyLeaf(ChessGame& pos, const Move& move, PieceColor opponent, PerftStats& stats) {
+    ++stats.nodes;
+    if (move.isEnPassant) { ++stats.enPassant; ++stats.captures; }
+    else if (!pos.board[move.toRow][move.toCol].isEmpty()) ++stats.captures;
+    if (move.isCastling) ++stats.castles;
+    if (pos.board[move.fromRow][move.fromCol].type == PieceType::PAWN && (move.toRow == 0 || move.toRow == 7)) ++stats.promotions;
+
+    ChessGame::SavedState saved = pos.saveState();
+    pos.applyMove(move);
+    if (pos.isInCheck(opponent)) ++stats.checks;
+    pos.restoreState(saved);
+}
+
+PerftStats ChessPerft::run(const ChessGame& game, int depth, std::vector<PerftDivide>* divide) {
+    PerftStats total;
+    if (depth < 1) { total.nodes = 1; return total; }
+
+    PieceColor side = game.sideToMove();
+    PieceColor opponent = (side == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    std::vector<Move> roots;
+    game.generatePseudoLegalMoves(side, roots);
+    game.validateMoves(roots, side);
+
+    // Root moves are handed out one at a time so threads stay busy on uneven subtrees
+    std::vector<PerftStats> results(roots.size());
+    std::atomic<size_t> next{ 0 };
+    int threads = std::min<int>(options.threads, (int)std::max<size_t>(1, roots.size()));
+    auto worker = [&](int index) {
+        CpuTopology::placeWorker(index, threads, options.placement);
+        ChessGame pos = game;
+        ChessGame::SavedState saved = pos.saveState();
+        for (size_t i = next++; i < roots.size(); i = next++) {
+            if (depth == 1) {
+                if (options.stats) tallyLeaf(pos, roots[i], opponent, results[i]);
+                else results[i].nodes = 1;
+                continue;
+            }
+            pos.applyMove(roots[i]);
+            if (options.stats) countStats(pos, opponent, depth - 1, results[i]);
+            else results[i].nodes = count(pos, opponent, depth - 1);
+            pos.restoreState(saved);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& t : pool) t.join();
+
+    for (size_t i = 0; i < roots.size(); ++i) {
+        total.add(results[i]);
+        if (divide) divide->push_back(PerftDivide{ roots[i], results[i].nodes });
+    }
+    return total;
+}
+
+struct PerftReference {
+    const char* name;
+    const char* fen;
+    uint64_t nodes[6]; // expected counts for depth 1..6, 0 = not checked
+    int depth;         // default suite depth
+    int deepDepth;     // depth used with --deep
+};
+
+// Standard perft positions (chessprogramming.org "Perft Results")
+static const PerftReference kPerftSuite[] = {
+    { "start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", { 20, 400, 8902, 197281, 4865609, 0 }, 4, 5 },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", { 48, 2039, 97862, 4085603, 0, 0 }, 3, 4 },
+    { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", { 14, 191, 2812, 43238, 674624, 0 }, 4, 5 },
+    { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", { 6, 264, 9467, 422333, 0, 0 }, 3, 4 },
+    { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", { 44, 1486, 62379, 2103487, 0, 0 }, 3, 4 },
+    { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", { 46, 2079, 89890, 3894594, 0, 0 }, 3, 4 },
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static int runSuite(const PerftOptions& options, bool deep, double minNps) {
+    int failures = 0;
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0.0;
+    for (const auto& ref : kPerftSuite) {
+        ChessGame game;
+        game.loadFEN(ref.fen);
+        int depth = deep ? ref.deepDepth : ref.depth;
+        ChessPerft perft(options);
+        auto t0 = std::chrono::steady_clock::now();
+        PerftStats stats = perft.run(game, depth);
+        double seconds = secondsSince(t0);
+        uint64_t expected = ref.nodes[depth - 1];
+        bool ok = stats.nodes == expected;
+        if (!ok) ++failures;
+        totalNodes += stats.nodes;
+        totalSeconds += seconds;
+        printf("%-10s depth %d  %12llu  expected %12llu  %8.2fs  %s\n", ref.name, depth,
+            (unsigned long long)stats.nodes, (unsigned long long)expected, seconds, ok ? "ok" : "MISMATCH");
+    }
+    double nps = totalSeconds > 0 ? totalNodes / totalSeconds : 0.0;
+    printf("total %llu nodes in %.2fs, %.0f nodes/s\n", (unsigned long long)totalNodes, totalSeconds, nps);
+    if (minNps > 0 && nps < minNps) {
+        printf("performance gate failed: %.0f < %.0f nodes/s\n", nps, minNps);
+        ++failures;
+    }
+    return failures ? 1 : 0;
+}
+
+int RunPerftTool(int argc, char** argv) {
+    // argv[0] is "--perft" or "--perft-suite"
+    bool suite = strcmp(argv[0], "--perft-suite") == 0;
+    PerftOptions options;
+    bool deep = false;
+    double minNps = 0.0;
+    int depth = 0;
+    std::string fen;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) options.threads = atoi(argv[++i]);
+        else if (arg == "--hash" && i + 1 < argc) options.hashMB = (size_t)atoi(argv[++i]);
+        else if (arg == "--stats") options.stats = true;
+        else if (arg == "--pin") options.placement.pin = true;
+        else if (arg == "--smt") options.placement.skipSMT = false;
+        else if (arg == "--deep") deep = true;
+        else if (arg == "--min-nps" && i + 1 < argc) minNps = atof(argv[++i]);
+        else if (depth == 0 && !suite) depth = atoi(argv[i]);
+        else fen += (fen.empty() ? "" : " ") + arg; // FEN may be given quoted or as separate words
+    }
+    if (suite) return runSuite(options, deep, minNps);
+
+    if (depth < 1) {
+        printf("usage: --perft <depth> [fen] [--threads N] [--hash MB] [--stats] [--pin] [--smt]\n");
+        printf("       --perft-suite [--deep] [--threads N] [--hash MB] [--min-nps N] [--pin] [--smt]\n");
+        return 2;
+    }
+    ChessGame game;
+    if (fen.empty()) fen = kPerftSuite[0].fen;
+    if (!game.loadFEN(fen)) { printf("invalid FEN: %s\n", fen.c_str()); return 2; }
+
+    ChessPerft perft(options);
+    std::vector<PerftDivide> divide;
+    auto t0 = std::chrono::steady_clock::now();
+    PerftStats stats = perft.run(game, depth, &divide);
+    double seconds = secondsSince(t0);
+
+    for (const auto& d : divide) printf("%s: %llu\n", moveToString(d.move).c_str(), (unsigned long long)d.nodes);
+    printf("\nNodes: %llu\nTime: %.3fs\nNodes/s: %.0f\n", (unsigned long long)stats.nodes, seconds, seconds > 0 ? stats.nodes / seconds : 0.0);
+    if (options.stats) {
+        printf("Captures: %llu\nEn passant: %llu\nCastles: %llu\nPromotions: %llu\nChecks: %llu\n",
+            (unsigned long long)stats.captures, (unsigned long long)stats.enPassant, (unsigned long long)stats.castles,
+            (unsigned long long)stats.promotions, (unsigned long long)stats.checks);
+    }
+    return 0;
+}
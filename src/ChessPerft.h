@@ -0,0 +1,62 @@
+#pragma once
+#include "Chess.h"
+#include "CpuTopology.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Leaf-move counts; the detail counters are only filled when PerftOptions::stats is set
+struct PerftStats {
+    uint64_t nodes = 0;
+    uint64_t captures = 0;
+    uint64_t enPassant = 0;
+    uint64_t castles = 0;
+    uint64_t promotions = 0;
+    uint64_t checks = 0;
+
+    void add(const PerftStats& o) {
+        nodes += o.nodes; captures += o.captures; enPassant += o.enPassant;
+        castles += o.castles; promotions += o.promotions; checks += o.checks;
+    }
+};
+
+struct PerftOptions {
+    int threads = 1;     // root moves are split across this many threads
+    size_t hashMB = 16;  // 0 disables the perft hash table
+    bool stats = false;  // per-leaf capture/ep/castle/promotion/check counts (disables bulk counting and hashing)
+    ThreadPlacement placement;
+};
+
+struct PerftDivide {
+    Move move;
+    uint64_t nodes;
+};
+
+// Move generator verification: counts the leaves of the legal move tree to a fixed depth
+class ChessPerft {
+public:
+    explicit ChessPerft(const PerftOptions& options = PerftOptions{});
+
+    PerftStats run(const ChessGame& game, int depth, std::vector<PerftDivide>* divide = nullptr);
+
+private:
+    uint64_t count(ChessGame& pos, PieceColor side, int depth);
+    void countStats(ChessGame& pos, PieceColor side, int depth, PerftStats& stats);
+    void tallyLeaf(ChessGame& pos, const Move& move, PieceColor opponent, PerftStats& stats);
+    bool probe(uint64_t key, uint64_t& nodes) const;
+    void store(uint64_t key, uint64_t nodes);
+
+    // Lock-free (key ^ nodes, nodes) slots shared by all worker threads
+    struct Slot {
+        std::atomic<uint64_t> check{ 0 };
+        std::atomic<uint64_t> nodes{ 0 };
+    };
+    PerftOptions options;
+    std::unique_ptr<Slot[]> table;
+    size_t slotCount = 0;
+};
+
+// Console front end: --perft <depth> [fen] [--threads N] [--hash MB] [--stats] [--pin] [--smt]
+//                    --perft-suite [--deep] [--threads N] [--min-nps N] [--pin] [--smt]
+int RunPerftTool(int argc, char** argv);
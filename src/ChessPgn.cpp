@@ -0,0 +1,436 @@
+#include "ChessPgn.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+static PieceColor opposite(PieceColor c) {
+    return (c == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+}
+
+static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static PieceType pieceFromLetter(char c) {
+    switch (c) {
+    case 'K': return PieceType::KING;
+    case 'Q': return PieceType::QUEEN;
+    case 'R': return PieceType::ROOK;
+    case 'B': return PieceType::BISHOP;
+    case 'N': return PieceType::KNIGHT;
+    default: return PieceType::EMPTY;
+    }
+}
+
+static char letterFromPiece(PieceType t) {
+    switch (t) {
+    case PieceType::KING: return 'K';
+    case PieceType::QUEEN: return 'Q';
+    case PieceType::ROOK: return 'R';
+    case PieceType::BISHOP: return 'B';
+    case PieceType::KNIGHT: return 'N';
+    default: return 0;
+    }
+}
+
+static bool parseResult(std::string_view token, GameResult& result) {
+    if (token == "1-0") result = GameResult::WHITE_WINS;
+    else if (token == "0-1") result = GameResult::BLACK_WINS;
+    else if (token == "1/2-1/2") result = GameResult::DRAW;
+    else if (token == "*") result = GameResult::UNKNOWN;
+    else return false;
+    return true;
+}
+
+static const char* resultText(GameResult r) {
+    switch (r) {
+    case GameResult::WHITE_WINS: return "1-0";
+    case GameResult::BLACK_WINS: return "0-1";
+    case GameResult::DRAW: return "1/2-1/2";
+    default: return "*";
+    }
+}
+
+void PgnImporter::legalMoves(const ChessGame& pos, PieceColor side, std::vector<Move>& moves) {
+    pos.generatePseudoLegalMoves(side, moves);
+    pos.validateMoves(moves, side);
+}
+
+bool PgnImporter::parseSAN(const ChessGame& pos, PieceColor side, std::string_view san, Move& out) {
+    while (!san.empty() && strchr("+#!?", san.back())) san.remove_suffix(1);
+    // Candidates are filtered on the pseudo-legal list; only the survivors pay for the legality test
+    std::vector<Move> moves;
+    pos.generatePseudoLegalMoves(side, moves);
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        int toCol = (san.size() == 3) ? 6 : 2;
+        moves.erase(std::remove_if(moves.begin(), moves.end(), [&](const Move& m) {
+            return pos.board[m.fromRow][m.fromCol].type != PieceType::KING || m.fromCol != 4 || m.toCol != toCol;
+        }), moves.end());
+        pos.validateMoves(moves, side);
+        if (moves.size() != 1) return false;
+        out = moves[0];
+        return true;
+    }
+
+    PieceType piece = PieceType::PAWN;
+    if (!san.empty() && pieceFromLetter(san[0]) != PieceType::EMPTY) {
+        piece = pieceFromLetter(san[0]);
+        san.remove_prefix(1);
+    }
+    PieceType promotion = PieceType::QUEEN;
+    size_t eq = san.find('=');
+    if (eq != std::string_view::npos) {
+        if (eq + 1 >= san.size() || pieceFromLetter(san[eq + 1]) == PieceType::EMPTY) return false;
+        promotion = pieceFromLetter(san[eq + 1]);
+        san = san.substr(0, eq);
+    }
+    else if (piece == PieceType::PAWN && san.size() >= 3 && pieceFromLetter(san.back()) != PieceType::EMPTY) {
+        promotion = pieceFromLetter(san.back()); // "e8Q"
+        san.remove_suffix(1);
+    }
+
+    if (san.size() < 2) return false;
+    int toCol = san[san.size() - 2] - 'a';
+    int toRow = '8' - san[san.size() - 1];
+    if (toCol < 0 || toCol > 7 || toRow < 0 || toRow > 7) return false;
+    san.remove_suffix(2);
+
+    // Whatever is left is disambiguation (file and/or rank) and capture marks
+    int fromCol = -1, fromRow = -1;
+    for (char c : san) {
+        if (c >= 'a' && c <= 'h') fromCol = c - 'a';
+        else if (c >= '1' && c <= '8') fromRow = '8' - c;
+        else if (c != 'x' && c != '-' && c != ':') return false;
+    }
+
+    moves.erase(std::remove_if(moves.begin(), moves.end(), [&](const Move& m) {
+        return m.toRow != toRow || m.toCol != toCol
+            || pos.board[m.fromRow][m.fromCol].type != piece
+            || (fromCol >= 0 && m.fromCol != fromCol)
+            || (fromRow >= 0 && m.fromRow != fromRow)
+            || (piece == PieceType::PAWN && (toRow == 0 || toRow == 7) && m.promotion != promotion);
+    }), moves.end());
+    pos.validateMoves(moves, side);
+    if (moves.size() != 1) return false;
+    out = moves[0];
+    return true;
+}
+
+std::string PgnImporter::toSAN(const ChessGame& pos, PieceColor side, const Move& move) {
+    const Piece& mover = pos.board[move.fromRow][move.fromCol];
+    bool capture = move.isEnPassant || !pos.board[move.toRow][move.toCol].isEmpty()
+        || (mover.type == PieceType::PAWN && move.fromCol != move.toCol);
+    std::string san;
+    if (mover.type == PieceType::KING && std::abs(move.toCol - move.fromCol) == 2) {
+        san = (move.toCol == 6) ? "O-O" : "O-O-O";
+    }
+    else {
+        std::vector<Move> moves;
+        legalMoves(pos, side, moves);
+        if (mover.type == PieceType::PAWN) {
+            if (capture) san += (char)('a' + move.fromCol);
+        }
+        else {
+            san += letterFromPiece(mover.type);
+            // Disambiguate by file, else rank, else both
+            bool clash = false, sameFile = false, sameRank = false;
+            for (const auto& m : moves) {
+                if (m.toRow != move.toRow || m.toCol != move.toCol || (m.fromRow == move.fromRow && m.fromCol == move.fromCol)) continue;
+                if (pos.board[m.fromRow][m.fromCol].type != mover.type) continue;
+                clash = true;
+                if (m.fromCol == move.fromCol) sameFile = true;
+                if (m.fromRow == move.fromRow) sameRank = true;
+            }
+            if (clash && (!sameFile || sameRank)) san += (char)('a' + move.fromCol);
+            if (clash && sameFile) san += (char)('8' - move.fromRow);
+        }
+        if (capture) san += 'x';
+        san += (char)('a' + move.toCol);
+        san += (char)('8' - move.toRow);
+        if (mover.type == PieceType::PAWN && (move.toRow == 0 || move.toRow == 7)) {
+            san += '=';
+            san += letterFromPiece(move.promotion);
+        }
+    }
+
+    ChessGame next = pos;
+    next.applyMove(move);
+    PieceColor opponent = opposite(side);
+    if (next.isInCheck(opponent)) {
+        std::vector<Move> replies;
+        legalMoves(next, opponent, replies);
+        san += replies.empty() ? '#' : '+';
+    }
+    return san;
+}
+
+void PgnImporter::parseRange(const char* p, const char* end, Chunk& out) {
+    ChessGame pos;
+    PieceColor side = PieceColor::WHITE;
+    std::vector<uint16_t> game;
+    GameResult result = GameResult::UNKNOWN;
+    bool inGame = false, sawMoves = false, bad = false;
+
+    auto beginGame = [&]() {
+        pos.reset();
+        side = PieceColor::WHITE;
+        game.clear();
+        result = GameResult::UNKNOWN;
+        inGame = true;
+        sawMoves = bad = false;
+    };
+    auto finishGame = [&]() {
+        if (!inGame) return;
+        inGame = false;
+        if (bad) { ++out.skipped; return; }
+        GameDatabase::IndexEntry e{};
+        e.firstMove = out.moves.size();
+        e.plies = (uint32_t)game.size();
+        e.result = (uint8_t)result;
+        out.index.push_back(e);
+        out.moves.insert(out.moves.end(), game.begin(), game.end());
+    };
+
+    while (p < end) {
+        char c = *p;
+        if (isBlank(c) || c == ')') { ++p; continue; }
+        if (c == '[') {
+            // Tag pair: [Name "Value"]. A tag after movetext starts the next game.
+            if (sawMoves) finishGame();
+            if (!inGame) beginGame();
+            const char* name = ++p;
+            while (p < end && !isBlank(*p) && *p != ']' && *p != '"') ++p;
+            std::string_view tag(name, p - name);
+            while (p < end && *p != '"' && *p != ']') ++p;
+            std::string_view value;
+            if (p < end && *p == '"') {
+                const char* v = ++p;
+                while (p < end && *p != '"') p += (*p == '\\' && p + 1 < end) ? 2 : 1;
+                value = std::string_view(v, p - v);
+            }
+            while (p < end && *p != ']') ++p;
+            if (p < end) ++p;
+            if (tag == "FEN") bad = true; // only games from the initial position are stored
+            else if (tag == "Result") parseResult(value, result);
+            continue;
+        }
+        if (c == '{') {
+            while (p < end && *p != '}') ++p;
+            if (p < end) ++p;
+            continue;
+        }
+        if (c == ';' || c == '%') {
+            while (p < end && *p != '\n') ++p;
+            continue;
+        }
+        if (c == '(') {
+            // Variations nest and may hold comments with parentheses in them
+            int depth = 0;
+            while (p < end) {
+                if (*p == '{') { while (p < end && *p != '}') ++p; }
+                else if (*p == '(') ++depth;
+                else if (*p == ')' && --depth == 0) { ++p; break; }
+                if (p < end) ++p;
+            }
+            continue;
+        }
+
+        const char* token = p;
+        while (p < end && !isBlank(*p) && *p != '{' && *p != '(' && *p != ')' && *p != ';' && *p != '[') ++p;
+        std::string_view tok(token, p - token);
+        if (!inGame) beginGame();
+        GameResult r;
+        if (parseResult(tok, r)) {
+            result = r;
+            finishGame();
+            continue;
+        }
+        if (tok[0] == '$' || tok == "e.p.") continue; // NAGs and ep annotations
+
+        // Move numbers, also when glued to the move ("12.e4", "12...Nf6")
+        size_t digits = 0;
+        while (digits < tok.size() && tok[digits] >= '0' && tok[digits] <= '9') ++digits;
+        if (digits > 0 && (digits == tok.size() || tok[digits] == '.')) {
+            while (digits < tok.size() && tok[digits] == '.') ++digits;
+            tok.remove_prefix(digits);
+        }
+        if (tok.empty()) continue;
+
+        sawMoves = true;
+        if (bad) continue;
+        Move m(0, 0, 0, 0);
+        if (!parseSAN(pos, side, tok, m)) { bad = true; continue; }
+        game.push_back(packMove(m));
+        pos.applyMove(m);
+        side = opposite(side);
+    }
+    finishGame();
+}
+
+bool PgnImporter::import(const std::string& pgnPath, const std::string& dbPath, PgnImportStats& stats) {
+    auto t0 = std::chrono::steady_clock::now();
+    MappedFile input;
+    if (!input.open(pgnPath)) return false;
+    const char* begin = input.data();
+    const char* end = begin + input.size();
+
+    // Chunk boundaries are moved forward to the next game's Event tag so no game is split
+    std::vector<const char*> bounds{ begin };
+    std::string_view all(begin, input.size());
+    for (int t = 1; t < threadCount; ++t) {
+        size_t from = std::max<size_t>((size_t)(bounds.back() - begin), input.size() * t / threadCount);
+        size_t at = all.find("\n[Event ", from);
+        if (at == std::string_view::npos) break;
+        bounds.push_back(begin + at + 1);
+    }
+    bounds.push_back(end);
+
+    std::vector<Chunk> chunks(bounds.size() - 1);
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < chunks.size(); ++i) pool.emplace_back(parseRange, bounds[i], bounds[i + 1], std::ref(chunks[i]));
+    parseRange(bounds[0], bounds[1], chunks[0]);
+    for (auto& t : pool) t.join();
+
+    std::vector<GameDatabase::IndexEntry> index;
+    std::vector<uint16_t> moves;
+    stats = PgnImportStats{};
+    for (const auto& chunk : chunks) {
+        for (auto e : chunk.index) {
+            e.firstMove += moves.size();
+            index.push_back(e);
+        }
+        moves.insert(moves.end(), chunk.moves.begin(), chunk.moves.end());
+        stats.skipped += chunk.skipped;
+    }
+    stats.games = index.size();
+    stats.plies = moves.size();
+    bool ok = GameDatabase::write(dbPath, index, moves);
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return ok;
+}
+
+namespace {
+    const char kDbMagic[8] = { 'S', 'G', 'M', 'G', 'A', 'M', 'E', 'S' };
+    const uint32_t kDbVersion = 2;
+
+    struct DbHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t indexEntrySize;
+        uint64_t gameCount;
+        uint64_t moveCount;
+    };
+}
+
+bool GameDatabase::write(const std::string& path, const std::vector<IndexEntry>& index, const std::vector<uint16_t>& moves) {
+    DbHeader header{};
+    memcpy(header.magic, kDbMagic, sizeof(kDbMagic));
+    header.version = kDbVersion;
+    header.indexEntrySize = sizeof(IndexEntry);
+    header.gameCount = index.size();
+    header.moveCount = moves.size();
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+        && (index.empty() || fwrite(index.data(), sizeof(IndexEntry), index.size(), f) == index.size())
+        && (moves.empty() || fwrite(moves.data(), sizeof(uint16_t), moves.size(), f) == moves.size());
+    return (fclose(f) == 0) && ok;
+}
+
+bool GameDatabase::open(const std::string& path) {
+    close();
+    if (!file.open(path) || file.size() < sizeof(DbHeader)) { file.close(); return false; }
+    const DbHeader* header = (const DbHeader*)file.data();
+    bool valid = memcmp(header->magic, kDbMagic, sizeof(kDbMagic)) == 0
+        && header->version == kDbVersion
+        && header->indexEntrySize == sizeof(IndexEntry)
+        && file.size() == sizeof(DbHeader) + header->gameCount * sizeof(IndexEntry) + header->moveCount * sizeof(uint16_t);
+    if (!valid) { close(); return false; }
+    index = (const IndexEntry*)(header + 1);
+    moves = (const uint16_t*)(index + header->gameCount);
+    gameCount = (size_t)header->gameCount;
+    return true;
+}
+
+void GameDatabase::close() {
+    file.close();
+    index = nullptr;
+    moves = nullptr;
+    gameCount = 0;
+}
+
+GameDatabase::Game GameDatabase::game(size_t id) const {
+    Game g;
+    if (id >= gameCount) return g;
+    g.result = (GameResult)index[id].result;
+    g.moves = moves + index[id].firstMove;
+    g.plies = index[id].plies;
+    return g;
+}
+
+bool GameDatabase::replay(size_t id, ChessGame& out, size_t plies) const {
+    if (id >= gameCount) return false;
+    Game g = game(id);
+    out.reset();
+    PieceColor side = PieceColor::WHITE;
+    for (size_t i = 0; i < g.plies && i < plies; ++i) {
+        // applyMove recognizes castling and en passant from the squares alone
+        out.applyMove(unpackMove(g.moves[i]));
+        out.history.push_back(unpackMove(g.moves[i]));
+        side = opposite(side);
+    }
+    out.currentPlayer = side;
+    ++out.positionVersion;
+    out.checkGameState();
+    return true;
+}
+
+std::string GameDatabase::movetext(size_t id) const {
+    Game g = game(id);
+    ChessGame pos;
+    pos.reset();
+    PieceColor side = PieceColor::WHITE;
+    std::string text;
+    for (size_t i = 0; i < g.plies; ++i) {
+        Move m = unpackMove(g.moves[i]);
+        if (side == PieceColor::WHITE) text += std::to_string(i / 2 + 1) + ". ";
+        text += PgnImporter::toSAN(pos, side, m) + " ";
+        pos.applyMove(m);
+        side = opposite(side);
+    }
+    return text + resultText(g.result);
+}
+
+int RunPgnTool(int argc, char** argv) {
+    // argv[0] is "--pgn-import" or "--pgn-show"
+    if (strcmp(argv[0], "--pgn-show") == 0 && argc >= 3) {
+        GameDatabase db;
+        if (!db.open(argv[1])) { printf("cannot open game database %s\n", argv[1]); return 1; }
+        size_t id = (size_t)strtoull(argv[2], nullptr, 10);
+        if (id >= db.size()) { printf("game %zu out of range (%zu games)\n", id, db.size()); return 1; }
+        printf("%s\n", db.movetext(id).c_str());
+        return 0;
+    }
+    if (strcmp(argv[0], "--pgn-import") == 0 && argc >= 3) {
+        int threads = 1;
+        for (int i = 3; i + 1 < argc; ++i) {
+            if (strcmp(argv[i], "--threads") == 0) threads = atoi(argv[i + 1]);
+        }
+        PgnImporter importer(threads);
+        PgnImportStats stats;
+        if (!importer.import(argv[1], argv[2], stats)) { printf("import failed\n"); return 1; }
+        printf("%llu games (%llu skipped), %llu plies in %.2fs, %.0f games/s\n", (unsigned long long)stats.games,
+            (unsigned long long)stats.skipped, (unsigned long long)stats.plies, stats.seconds,
+            stats.seconds > 0 ? stats.games / stats.seconds : 0.0);
+        return 0;
+    }
+    printf("usage: --pgn-import <in.pgn> <out.db> [--threads N]\n");
+    printf("       --pgn-show <db> <game id>\n");
+    return 2;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "Chess.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class GameResult : uint8_t { UNKNOWN, WHITE_WINS, BLACK_WINS, DRAW };
+
+// Binary game store written by PgnImporter: a header, one index entry per game, then every
+// game's moves back to back as packMove() values. Opened read-only through a mapping.
+class GameDatabase {
+public:
+    struct Game {
+        GameResult result = GameResult::UNKNOWN;
+        const uint16_t* moves = nullptr;
+        size_t plies = 0;
+    };
+
+    bool open(const std::string& path);
+    void close();
+    size_t size() const { return gameCount; }
+    Game game(size_t id) const;
+    // Plays the first `plies` moves of a game from the initial position into `out`
+    bool replay(size_t id, ChessGame& out, size_t plies = SIZE_MAX) const;
+    // SAN movetext of a game, with move numbers and the result
+    std::string movetext(size_t id) const;
+
+    struct IndexEntry {
+        uint64_t firstMove;
+        uint32_t plies;
+        uint8_t result;
+        uint8_t reserved[3];
+    };
+    static bool write(const std::string& path, const std::vector<IndexEntry>& index, const std::vector<uint16_t>& moves);
+
+private:
+    MappedFile file;
+    const IndexEntry* index = nullptr;
+    const uint16_t* moves = nullptr;
+    size_t gameCount = 0;
+};
+
+struct PgnImportStats {
+    uint64_t games = 0;
+    uint64_t skipped = 0; // illegal/ambiguous SAN, or a non-standard start position (FEN tag)
+    uint64_t plies = 0;
+    double seconds = 0.0;
+};
+
+// Streaming PGN reader: the input is mapped and tokenized in place, split on game boundaries
+// across threads, and every SAN move is resolved against the ChessGame move generator.
+class PgnImporter {
+public:
+    explicit PgnImporter(int threads = 1) : threadCount(threads < 1 ? 1 : threads) {}
+
+    bool import(const std::string& pgnPath, const std::string& dbPath, PgnImportStats& stats);
+
+    // SAN <-> Move for `side` to move in `pos`
+    static bool parseSAN(const ChessGame& pos, PieceColor side, std::string_view san, Move& out);
+    static std::string toSAN(const ChessGame& pos, PieceColor side, const Move& move);
+
+private:
+    struct Chunk {
+        std::vector<GameDatabase::IndexEntry> index; // firstMove relative to this chunk
+        std::vector<uint16_t> moves;
+        uint64_t skipped = 0;
+    };
+    static void parseRange(const char* begin, const char* end, Chunk& out);
+    static void legalMoves(const ChessGame& pos, PieceColor side, std::vector<Move>& moves);
+
+    int threadCount;
+};
+
+// Console front end: --pgn-import <in.pgn> <out.db> [--threads N]
+//                    --pgn-show <db> <game id>
+int RunPgnTool(int argc, char** argv);
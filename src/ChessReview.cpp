@@ -0,0 +1,174 @@
+#include "ChessReview.h"
+#include "ChessPgn.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// Mate scores would swamp the averages; anything past ten pawns counts as ten pawns
+static int capScore(int score) {
+    return std::max(-1000, std::min(1000, score));
+}
+
+static MoveGrade gradeFor(int loss, bool best) {
+    if (loss >= 300) return MoveGrade::BLUNDER;
+    if (loss >= 100) return MoveGrade::MISTAKE;
+    if (loss >= 50) return MoveGrade::INACCURACY;
+    return best ? MoveGrade::BEST : MoveGrade::GOOD;
+}
+
+GameReviewer::GameReviewer(const ReviewOptions& options) : options(options) {}
+
+GameReviewer::~GameReviewer() {
+    cancel();
+}
+
+void GameReviewer::start(const ChessGame& game) {
+    cancel();
+
+    // Positions before every move, replayed on this thread; the copies share game's TT
+    ChessGame pos = game;
+    if (game.startFEN.empty()) pos.reset();
+    else pos.loadFEN(game.startFEN);
+    PieceColor side = pos.currentPlayer;
+    for (const Move& move : game.history) {
+        positions.push_back(pos);
+        ReviewedMove r;
+        r.mover = side;
+        r.played = move;
+        r.san = PgnImporter::toSAN(pos, side, move);
+        results.push_back(r);
+        pos.applyMove(move);
+        side = (side == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+        pos.currentPlayer = side;
+        ++pos.positionVersion;
+    }
+    if (positions.empty()) return;
+
+    int threads = options.threads > 0 ? options.threads : CpuTopology::system().threadsFor(options.placement);
+    threads = std::max(1, std::min(threads, (int)positions.size()));
+    coordinator = std::thread(&GameReviewer::run, this, threads);
+}
+
+void GameReviewer::cancel() {
+    abort = true;
+    wait();
+    positions.clear();
+    results.clear();
+    next = 0;
+    done = 0;
+    finished = false;
+    abort = false;
+    elapsed = 0.0;
+}
+
+void GameReviewer::wait() {
+    if (coordinator.joinable()) coordinator.join();
+}
+
+void GameReviewer::run(int threads) {
+    auto t0 = std::chrono::steady_clock::now();
+    auto work = [this, threads](int index) {
+        CpuTopology::placeWorker(index, threads, options.placement);
+        while (!abort.load(std::memory_order_relaxed)) {
+            size_t i = next.fetch_add(1);
+            if (i >= positions.size()) break;
+            reviewPosition(i);
+            done.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(work, t);
+    work(0);
+    for (auto& t : pool) t.join();
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    finished.store(true, std::memory_order_release);
+}
+
+void GameReviewer::reviewPosition(size_t index) {
+    ChessGame& pos = positions[index];
+    ReviewedMove& r = results[index];
+    PieceColor side = pos.currentPlayer;
+    PieceColor opponent = (side == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    pos.stopFlag = &abort;
+    pos.resetNodeCount();
+
+    // Iterative deepening under the node budget; the played move is scored at the same depth
+    for (int depth = 1; depth <= options.maxDepth; ++depth) {
+        int bestScore;
+        Move best = pos.searchBestMove(side, depth, &bestScore);
+        if (best.fromRow < 0 || abort.load(std::memory_order_relaxed)) break;
+
+        int playedScore = bestScore;
+        if (packMove(best) != packMove(r.played)) {
+            ChessGame::SavedState saved = pos.saveState();
+            pos.applyMove(r.played);
+            playedScore = pos.minimax(depth - 1, 1, -ChessGame::INF_SCORE, ChessGame::INF_SCORE, opponent);
+            pos.restoreState(saved);
+        }
+        if (abort.load(std::memory_order_relaxed)) break;
+
+        r.best = best;
+        r.bestScore = bestScore;
+        r.playedScore = playedScore;
+        r.depth = depth;
+        if (pos.nodeCount() * 4 > options.nodeBudget) break;
+    }
+    r.nodes = pos.nodeCount();
+    if (r.depth == 0) return;
+
+    int sign = (side == PieceColor::WHITE) ? 1 : -1;
+    bool playedBest = packMove(r.best) == packMove(r.played);
+    r.loss = std::max(0, sign * (capScore(r.bestScore) - capScore(r.playedScore)));
+    r.grade = gradeFor(r.loss, playedBest);
+    r.bestSan = playedBest ? r.san : PgnImporter::toSAN(pos, side, r.best);
+}
+
+ReviewSummary GameReviewer::summarize(const std::vector<ReviewedMove>& moves) {
+    ReviewSummary s;
+    int count[2] = {}, total[2] = {};
+    for (size_t i = 0; i < moves.size(); ++i) {
+        int side = (moves[i].mover == PieceColor::WHITE) ? 0 : 1;
+        ++count[side];
+        total[side] += moves[i].loss;
+        switch (moves[i].grade) {
+        case MoveGrade::INACCURACY: ++s.inaccuracies[side]; break;
+        case MoveGrade::MISTAKE: ++s.mistakes[side]; break;
+        case MoveGrade::BLUNDER: ++s.blunders[side]; break;
+        default: break;
+        }
+    }
+    for (int side = 0; side < 2; ++side) s.averageLoss[side] = count[side] ? total[side] / count[side] : 0;
+    return s;
+}
+
+const char* GameReviewer::gradeSuffix(MoveGrade grade) {
+    switch (grade) {
+    case MoveGrade::INACCURACY: return "?!";
+    case MoveGrade::MISTAKE: return "?";
+    case MoveGrade::BLUNDER: return "??";
+    default: return "";
+    }
+}
+
+std::string GameReviewer::report(const std::vector<ReviewedMove>& moves) {
+    std::string out;
+    char line[160];
+    out += "move            best         before    after  loss depth     nodes\n";
+    int number = 1;
+    for (const ReviewedMove& m : moves) {
+        std::string played = m.san + gradeSuffix(m.grade);
+        snprintf(line, sizeof(line), "%3d%s %-10s %-10s %8s %8s %5d  d%d %9llu\n", number,
+            (m.mover == PieceColor::BLACK) ? "..." : ". ",
+            played.c_str(), m.bestSan.c_str(), formatScore(m.bestScore).c_str(), formatScore(m.playedScore).c_str(),
+            m.loss, m.depth, (unsigned long long)m.nodes);
+        out += line;
+        if (m.mover == PieceColor::BLACK) ++number;
+    }
+    ReviewSummary s = summarize(moves);
+    for (int side = 0; side < 2; ++side) {
+        snprintf(line, sizeof(line), "%s: average loss %d cp, %d inaccuracies, %d mistakes, %d blunders\n",
+            side == 0 ? "White" : "Black", s.averageLoss[side], s.inaccuracies[side], s.mistakes[side], s.blunders[side]);
+        out += line;
+    }
+    return out;
+}
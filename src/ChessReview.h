@@ -0,0 +1,80 @@
+#pragma once
+#include "Chess.h"
+#include "CpuTopology.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class MoveGrade : uint8_t { BEST, GOOD, INACCURACY, MISTAKE, BLUNDER };
+
+struct ReviewedMove {
+    PieceColor mover = PieceColor::WHITE;
+    Move played{ -1, -1, -1, -1 };
+    Move best{ -1, -1, -1, -1 };
+    std::string san;         // played move
+    std::string bestSan;
+    int bestScore = 0;       // White-relative, from the position before the move
+    int playedScore = 0;     // same depth, after the played move
+    int loss = 0;            // centipawns the mover gave up; mate scores are capped first
+    int depth = 0;           // deepest completed iteration
+    uint64_t nodes = 0;
+    MoveGrade grade = MoveGrade::BEST;
+};
+
+struct ReviewOptions {
+    int threads = 0;                // 0 = CpuTopology::threadsFor(placement)
+    ThreadPlacement placement;
+    int maxDepth = 4;               // the HARD playing depth
+    uint64_t nodeBudget = 400000;   // per position; no new iteration starts once a quarter of it is spent
+};
+
+// Per-side totals over a reviewed game ([0] = White, [1] = Black)
+struct ReviewSummary {
+    int averageLoss[2] = {};
+    int inaccuracies[2] = {};
+    int mistakes[2] = {};
+    int blunders[2] = {};
+};
+
+// Post-game accuracy review. Every position of the game's move list is an independent job:
+// a pool of worker threads pulls positions off a shared counter and searches each with its own
+// copy of the game, while all copies share the game's transposition table. Runs in the
+// background; the UI polls completed() and reads moves() once running() turns false.
+class GameReviewer {
+public:
+    explicit GameReviewer(const ReviewOptions& options = ReviewOptions{});
+    ~GameReviewer();
+    GameReviewer(const GameReviewer&) = delete;
+    GameReviewer& operator=(const GameReviewer&) = delete;
+
+    void start(const ChessGame& game); // reviews game.moveHistory(); cancels a review in progress
+    void cancel();                     // stops the workers and discards the results
+    void wait();                       // blocks until the current review is finished
+
+    bool started() const { return total() > 0; }
+    bool running() const { return started() && !finished.load(std::memory_order_acquire); }
+    int completed() const { return done.load(std::memory_order_relaxed); }
+    int total() const { return (int)results.size(); }
+    double seconds() const { return elapsed; }
+    const std::vector<ReviewedMove>& moves() const { return results; } // only once !running()
+
+    static ReviewSummary summarize(const std::vector<ReviewedMove>& moves);
+    static const char* gradeSuffix(MoveGrade grade); // "", "?!", "?", "??"
+    static std::string report(const std::vector<ReviewedMove>& moves); // console table
+
+private:
+    void run(int threads);
+    void reviewPosition(size_t index);
+
+    ReviewOptions options;
+    std::vector<ChessGame> positions; // before each move
+    std::vector<ReviewedMove> results;
+    std::thread coordinator;
+    std::atomic<size_t> next{ 0 };
+    std::atomic<int> done{ 0 };
+    std::atomic<bool> finished{ false };
+    std::atomic<bool> abort{ false };
+    double elapsed = 0.0;
+};
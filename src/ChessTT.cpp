@@ -0,0 +1,200 @@
+#include "ChessTT.h"
+#include "CpuTopology.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <new>
+#include <thread>
+
+TranspositionTable::TranspositionTable(size_t megabytes, bool interleave) {
+    size_t wanted = megabytes * 1024 * 1024 / sizeof(Slot);
+    slotCount = 1;
+    while (slotCount * 2 <= wanted) slotCount *= 2;
+    slots.reset(static_cast<Slot*>(std::calloc(slotCount, sizeof(Slot))));
+    if (!slots) throw std::bad_alloc();
+    constructSlots(interleave);
+}
+
+uint64_t TranspositionTable::pack(int depth, int score, TTBound bound, uint16_t move) {
+    return (uint64_t)(uint32_t)score | ((uint64_t)move << 32) | ((uint64_t)(uint8_t)depth << 48) | ((uint64_t)bound << 56);
+}
+
+bool TranspositionTable::unpack(uint64_t data, TTEntry& out) {
+    TTBound bound = (TTBound)(data >> 56);
+    if (bound == TTBound::NONE) return false;
+    out.score = (int)(int32_t)(uint32_t)data;
+    out.move = (uint16_t)(data >> 32);
+    out.depth = depthOf(data);
+    out.bound = bound;
+    return true;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& out) const {
+    const Slot& s = slots[key & (slotCount - 1)];
+    uint64_t data = s.data.load(std::memory_order_relaxed);
+    uint64_t check = s.check.load(std::memory_order_relaxed);
+    if ((check ^ data) == key && unpack(data, out)) return true;
+    return disk && disk->probe(key, data) && unpack(data, out);
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, TTBound bound, uint16_t move) {
+    Slot& s = slots[key & (slotCount - 1)];
+    uint64_t old = s.data.load(std::memory_order_relaxed);
+    bool sameKey = (s.check.load(std::memory_order_relaxed) ^ old) == key;
+    // Replacement: always take a different position, keep the deeper result for the same one
+    if (sameKey && (int)(uint8_t)(old >> 48) > depth && bound != TTBound::EXACT) return;
+    if (sameKey && move == 0) move = (uint16_t)(old >> 32);
+    uint64_t data = pack(depth, score, bound, move);
+    s.data.store(data, std::memory_order_relaxed);
+    s.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::constructSlots(bool interleave) {
+    // calloc's pages are untouched zero pages; a page lives on the node of the CPU that first
+    // writes it, which is the one constructing its slots. Interleaved, one thread pinned to each
+    // node constructs every n-th 2 MB chunk, so the chunks alternate between nodes.
+    std::map<int, int> nodeCpu;
+    if (interleave) {
+        for (const CpuInfo& c : CpuTopology::system().cpus()) nodeCpu.emplace(c.node, c.cpu);
+    }
+    if (nodeCpu.size() < 2) {
+        for (size_t i = 0; i < slotCount; ++i) new (&slots[i]) Slot{};
+        return;
+    }
+
+    const size_t chunkSlots = (2u << 20) / sizeof(Slot);
+    const size_t stride = chunkSlots * nodeCpu.size();
+    std::vector<std::thread> pool;
+    size_t first = 0;
+    for (const auto& node : nodeCpu) {
+        int cpu = node.second;
+        pool.emplace_back([this, cpu, first, stride, chunkSlots] {
+            CpuTopology::pinCurrentThread(cpu);
+            for (size_t chunk = first; chunk < slotCount; chunk += stride) {
+                size_t end = std::min(chunk + chunkSlots, slotCount);
+                for (size_t i = chunk; i < end; ++i) new (&slots[i]) Slot{};
+            }
+        });
+        first += chunkSlots;
+    }
+    for (auto& t : pool) t.join();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < slotCount; ++i) {
+        slots[i].data.store(0, std::memory_order_relaxed);
+        slots[i].check.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TranspositionTable::openDiskCache(const std::string& path) {
+    auto cache = std::make_unique<TTDiskCache>();
+    if (!cache->open(path)) return false;
+    disk = std::move(cache);
+    return true;
+}
+
+bool TranspositionTable::saveDiskCache(const std::string& path, int minDepth, size_t maxEntries) {
+    std::vector<TTRecord> records;
+    for (size_t i = 0; i < slotCount; ++i) {
+        uint64_t data = slots[i].data.load(std::memory_order_relaxed);
+        uint64_t key = slots[i].check.load(std::memory_order_relaxed) ^ data;
+        if ((TTBound)(data >> 56) != TTBound::NONE && depthOf(data) >= minDepth) records.push_back(TTRecord{ key, data });
+    }
+    if (disk) records.insert(records.end(), disk->begin(), disk->end());
+
+    // One record per key, the deeper one (in-memory wins ties since it comes first)
+    std::stable_sort(records.begin(), records.end(), [](const TTRecord& a, const TTRecord& b) {
+        return a.key != b.key ? a.key < b.key : depthOf(a.data) > depthOf(b.data);
+    });
+    records.erase(std::unique(records.begin(), records.end(), [](const TTRecord& a, const TTRecord& b) { return a.key == b.key; }), records.end());
+    if (records.size() > maxEntries) {
+        std::nth_element(records.begin(), records.begin() + maxEntries, records.end(),
+            [](const TTRecord& a, const TTRecord& b) { return depthOf(a.data) > depthOf(b.data); });
+        records.resize(maxEntries);
+    }
+
+    disk.reset(); // unmapped before the file is replaced
+    return TTDiskCache::write(path, records);
+}
+
+// Disk cache file: header followed by key-sorted records
+namespace {
+    const char kCacheMagic[8] = { 'S', 'G', 'M', 'C', 'H', 'T', 'T', '\0' };
+    const uint32_t kCacheVersion = 5; // bumped whenever stored scores or packed moves change meaning
+
+    struct CacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t zobristCheck; // keys from a different Zobrist set are meaningless
+        uint64_t count;
+        uint64_t checksum;     // FNV-1a over the records
+    };
+
+    uint64_t zobristFingerprint() {
+        return Zobrist::blackToMove ^ Zobrist::piece[1][5][63] ^ Zobrist::castling[3] ^ Zobrist::enPassantFile[7];
+    }
+
+    uint64_t checksumOf(const TTRecord* records, size_t count) {
+        const unsigned char* p = (const unsigned char*)records;
+        uint64_t h = 0xCBF29CE484222325ULL;
+        for (size_t i = 0; i < count * sizeof(TTRecord); ++i) h = (h ^ p[i]) * 0x100000001B3ULL;
+        return h;
+    }
+}
+
+bool TTDiskCache::open(const std::string& path) {
+    close();
+    if (!file.open(path) || file.size() < sizeof(CacheHeader)) { file.close(); return false; }
+
+    const CacheHeader* header = (const CacheHeader*)file.data();
+    const TTRecord* body = (const TTRecord*)(header + 1);
+    bool valid = memcmp(header->magic, kCacheMagic, sizeof(kCacheMagic)) == 0
+        && header->version == kCacheVersion
+        && header->recordSize == sizeof(TTRecord)
+        && header->zobristCheck == zobristFingerprint()
+        && header->count == (file.size() - sizeof(CacheHeader)) / sizeof(TTRecord)
+        && file.size() == sizeof(CacheHeader) + header->count * sizeof(TTRecord)
+        && header->checksum == checksumOf(body, (size_t)header->count);
+    if (!valid) { close(); return false; }
+    records = body;
+    count = (size_t)header->count;
+    return true;
+}
+
+void TTDiskCache::close() {
+    file.close();
+    records = nullptr;
+    count = 0;
+}
+
+bool TTDiskCache::probe(uint64_t key, uint64_t& data) const {
+    const TTRecord* it = std::lower_bound(records, records + count, key, [](const TTRecord& r, uint64_t k) { return r.key < k; });
+    if (it == records + count || it->key != key) return false;
+    data = it->data;
+    return true;
+}
+
+bool TTDiskCache::write(const std::string& path, std::vector<TTRecord>& recs) {
+    std::sort(recs.begin(), recs.end(), [](const TTRecord& a, const TTRecord& b) { return a.key < b.key; });
+    CacheHeader header{};
+    memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.version = kCacheVersion;
+    header.recordSize = sizeof(TTRecord);
+    header.zobristCheck = zobristFingerprint();
+    header.count = recs.size();
+    header.checksum = checksumOf(recs.data(), recs.size());
+
+    // Written next to the target and renamed over it, so a crash never leaves a torn cache
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+        && (recs.empty() || fwrite(recs.data(), sizeof(TTRecord), recs.size(), f) == recs.size());
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) { std::remove(tmp.c_str()); return false; }
+    std::remove(path.c_str());
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
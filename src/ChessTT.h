@@ -0,0 +1,110 @@
+#pragma once
+#include "ChessTables.h"
+#include "MappedFile.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Zobrist keys for chess positions (square index = row * 8 + col), generated at compile time
+namespace Zobrist {
+    struct Keys {
+        uint64_t piece[2][6][64]; // [color][type - KING][square]
+        uint64_t blackToMove;
+        uint64_t castling[4];     // white K, white Q, black K, black Q
+        uint64_t enPassantFile[8];
+    };
+
+    // Fixed seed and draw order: the keys are part of the disk cache format (see zobristCheck)
+    constexpr Keys makeKeys() {
+        Keys k{};
+        uint64_t state = 0x2545F4914F6CDD1DULL;
+        for (auto& color : k.piece) for (auto& type : color) for (auto& sq : type) sq = ChessTables::splitmix64(state);
+        k.blackToMove = ChessTables::splitmix64(state);
+        for (auto& c : k.castling) c = ChessTables::splitmix64(state);
+        for (auto& f : k.enPassantFile) f = ChessTables::splitmix64(state);
+        return k;
+    }
+
+    inline constexpr Keys keys = makeKeys();
+    inline constexpr const auto& piece = keys.piece;
+    inline constexpr const uint64_t& blackToMove = keys.blackToMove;
+    inline constexpr const auto& castling = keys.castling;
+    inline constexpr const auto& enPassantFile = keys.enPassantFile;
+}
+
+enum class TTBound : uint8_t { NONE, EXACT, LOWER, UPPER };
+
+struct TTEntry {
+    int score = 0;
+    uint16_t move = 0; // packMove() encoding
+    int depth = -1;
+    TTBound bound = TTBound::NONE;
+};
+
+// Raw slot contents, as written to the on-disk cache
+struct TTRecord {
+    uint64_t key;
+    uint64_t data;
+};
+
+// Read-only second-level table: deep entries saved by a previous run, memory-mapped from a
+// versioned, checksummed file of key-sorted records. A missing or mismatched file is ignored.
+class TTDiskCache {
+public:
+    bool open(const std::string& path);
+    void close();
+    bool probe(uint64_t key, uint64_t& data) const;
+    size_t size() const { return count; }
+    const TTRecord* begin() const { return records; }
+    const TTRecord* end() const { return records + count; }
+
+    // Writes `records` (any order, unique keys) as a new cache file
+    static bool write(const std::string& path, std::vector<TTRecord>& records);
+
+private:
+    MappedFile file;
+    const TTRecord* records = nullptr;
+    size_t count = 0;
+};
+
+// Fixed-size, lock-free transposition table. Each slot stores (key ^ data, data) so a torn
+// write from a concurrent thread is detected on probe instead of returning garbage.
+class TranspositionTable {
+public:
+    // With interleave on a multi-node machine, the table's pages alternate between NUMA nodes
+    explicit TranspositionTable(size_t megabytes = 16, bool interleave = false);
+
+    bool probe(uint64_t key, TTEntry& out) const;
+    void store(uint64_t key, int depth, int score, TTBound bound, uint16_t move);
+    void clear();
+    size_t size() const { return slotCount; }
+
+    // Second-level table probed after in-memory misses. saveDiskCache merges the mapped entries
+    // with in-memory ones of at least minDepth and keeps the deepest maxEntries (~16 bytes each).
+    bool openDiskCache(const std::string& path);
+    bool saveDiskCache(const std::string& path, int minDepth = 2, size_t maxEntries = 1 << 17);
+
+private:
+    // Constructed in place over calloc'd memory (see constructSlots); freed without destructors
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+    struct FreeSlots {
+        static_assert(std::is_trivially_destructible<Slot>::value, "slots are freed without destructors");
+        void operator()(Slot* p) const { std::free(p); }
+    };
+    std::unique_ptr<Slot[], FreeSlots> slots;
+    size_t slotCount = 0;
+    std::unique_ptr<TTDiskCache> disk;
+
+    void constructSlots(bool interleave);
+    static bool unpack(uint64_t data, TTEntry& out);
+    static int depthOf(uint64_t data) { return (int)(uint8_t)(data >> 48); }
+    static uint64_t pack(int depth, int score, TTBound bound, uint16_t move);
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+
+// Geometry tables for the chess engine, generated entirely at compile time so they cost
+// nothing at startup and live in read-only data. Square index = row * 8 + col, row 0 = rank 8.
+namespace ChessTables {
+
+struct SquareList {
+    uint8_t count = 0;
+    uint8_t squares[8] = {};
+};
+
+// Squares along one direction up to the board edge, nearest first
+struct Ray {
+    uint8_t length = 0;
+    uint8_t squares[7] = {};
+};
+
+// Direction order matches the move generator's kQueenDirs: four orthogonal, then four diagonal
+constexpr int kDirs[8][2] = { {-1,0}, {1,0}, {0,-1}, {0,1}, {-1,-1}, {-1,1}, {1,-1}, {1,1} };
+constexpr int kKnight[8][2] = { {-2,-1}, {-2,1}, {-1,-2}, {-1,2}, {1,-2}, {1,2}, {2,-1}, {2,1} };
+
+constexpr bool onBoard(int row, int col) { return row >= 0 && row < 8 && col >= 0 && col < 8; }
+constexpr int absDiff(int a, int b) { return a > b ? a - b : b - a; }
+constexpr int maxOf(int a, int b) { return a > b ? a : b; }
+
+struct Tables {
+    SquareList knight[64];
+    SquareList king[64];
+    SquareList pawnAttacks[2][64]; // [0] = White (attacks toward row 0), [1] = Black
+    Ray rays[8][64];
+    uint8_t distance[64][64];      // king steps between two squares
+    uint8_t centerDistance[64];    // 0 on the four center squares, 6 in the corners
+};
+
+constexpr Tables makeTables() {
+    Tables t{};
+    for (int sq = 0; sq < 64; ++sq) {
+        int row = sq / 8, col = sq % 8;
+        for (int i = 0; i < 8; ++i) {
+            int r = row + kKnight[i][0], c = col + kKnight[i][1];
+            if (onBoard(r, c)) t.knight[sq].squares[t.knight[sq].count++] = (uint8_t)(r * 8 + c);
+            r = row + kDirs[i][0], c = col + kDirs[i][1];
+            if (onBoard(r, c)) t.king[sq].squares[t.king[sq].count++] = (uint8_t)(r * 8 + c);
+            Ray& ray = t.rays[i][sq];
+            for (; onBoard(r, c); r += kDirs[i][0], c += kDirs[i][1]) ray.squares[ray.length++] = (uint8_t)(r * 8 + c);
+        }
+        for (int color = 0; color < 2; ++color) {
+            int r = row + (color == 0 ? -1 : 1);
+            for (int dc = -1; dc <= 1; dc += 2) {
+                if (onBoard(r, col + dc)) t.pawnAttacks[color][sq].squares[t.pawnAttacks[color][sq].count++] = (uint8_t)(r * 8 + col + dc);
+            }
+        }
+        for (int other = 0; other < 64; ++other) {
+            t.distance[sq][other] = (uint8_t)maxOf(absDiff(row, other / 8), absDiff(col, other % 8));
+        }
+        t.centerDistance[sq] = (uint8_t)(maxOf(3 - row, row - 4) + maxOf(3 - col, col - 4));
+    }
+    return t;
+}
+
+inline constexpr Tables kTables = makeTables();
+
+static_assert(kTables.knight[0].count == 2 && kTables.knight[27].count == 8, "knight targets");
+static_assert(kTables.king[63].count == 3 && kTables.rays[1][0].length == 7 && kTables.rays[7][0].squares[6] == 63, "king steps and rays");
+static_assert(kTables.distance[0][63] == 7 && kTables.centerDistance[0] == 6 && kTables.centerDistance[27] == 0, "distances");
+
+// splitmix64, usable in constant expressions (seeds the Zobrist keys)
+constexpr uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+}
@@ -3,6 +3,12 @@
 
 void ConnectFourGame::init(int screenWidth, int screenHeight) {
     screenW = screenWidth; screenH = screenHeight;
+    if (!table) table = std::make_shared<ConnectFourTT>();
+    if (!solver) {
+        solver = std::make_shared<ConnectFourSolver>();
+        solver->setBook(book.get());
+        solver->setThreads(CpuTopology::system().threadsFor(ThreadPlacement{}));
+    }
     reset();
     const float marginX = 40.0f;
     const float marginY = 80.0f;
@@ -16,8 +22,16 @@ void ConnectFourGame::init(int screenWidth, int screenHeight) {
     boardRect = { (screenWidth - bw) * 0.5f, (screenHeight - bh) * 0.5f, bw, bh };
 }
 
+bool ConnectFourGame::loadOpeningBook(const std::string& path) {
+    auto opened = std::make_shared<ConnectFourBook>();
+    if (!opened->open(path)) return false;
+    book = opened;
+    if (solver) solver->setBook(book.get());
+    return true;
+}
+
 void ConnectFourGame::reset() {
-    for (auto& row : board) row.fill(' ');
+    position = ConnectFourBoard{};
     gameOver = false;
     winner = ' ';
     current = 'R';
@@ -27,29 +41,27 @@ void ConnectFourGame::reset() {
     winningCount = 0;
 }
 
-int ConnectFourGame::lowestEmptyRow(int col) const {
-    if (col < 0 || col >= COLS) return -1;
-    for (int r = ROWS - 1; r >= 0; --r) if (board[r][col] == ' ') return r;
-    return -1;
+char ConnectFourGame::cellAt(int row, int col) const {
+    uint64_t cell = ConnectFourBoard::cellMask(row, col);
+    if (!(position.mask & cell)) return ' ';
+    return (position.firstPlayer() & cell) ? 'R' : 'Y';
 }
 
-bool ConnectFourGame::dropPiece(int col, char who) { // immediate place (used by AI search only)
-    int r = lowestEmptyRow(col);
-    if (r == -1) return false;
-    board[r][col] = who;
-    return true;
+int ConnectFourGame::lowestEmptyRow(int col) const {
+    if (col < 0 || col >= COLS || !position.canPlay(col)) return -1;
+    return ROWS - 1 - position.height(col);
 }
 
 bool ConnectFourGame::hasMoves() const {
-    for (int c = 0; c < COLS; ++c) if (board[0][c] == ' ') return true; return false;
+    return !position.full();
 }
 
 char ConnectFourGame::checkWinner() {
     // Horizontal
     winningCount = 0;
     for (int r = 0; r < ROWS; ++r) for (int c = 0; c <= COLS - 4; ++c) {
-        char ch = board[r][c]; if (ch == ' ') continue;
-        if (board[r][c + 1] == ch && board[r][c + 2] == ch && board[r][c + 3] == ch) {
+        char ch = cellAt(r, c); if (ch == ' ') continue;
+        if (cellAt(r, c + 1) == ch && cellAt(r, c + 2) == ch && cellAt(r, c + 3) == ch) {
             winningCount = 4;
             for (int i = 0; i < 4; ++i) winningPieces[i] = { boardRect.x + (c + i + 0.5f) * cellSize, boardRect.y + (r + 0.5f) * cellSize };
             return ch;
@@ -57,8 +69,8 @@ char ConnectFourGame::checkWinner() {
     }
     // Vertical
     for (int c = 0; c < COLS; ++c) for (int r = 0; r <= ROWS - 4; ++r) {
-        char ch = board[r][c]; if (ch == ' ') continue;
-        if (board[r + 1][c] == ch && board[r + 2][c] == ch && board[r + 3][c] == ch) {
+        char ch = cellAt(r, c); if (ch == ' ') continue;
+        if (cellAt(r + 1, c) == ch && cellAt(r + 2, c) == ch && cellAt(r + 3, c) == ch) {
             winningCount = 4;
             for (int i = 0; i < 4; ++i) winningPieces[i] = { boardRect.x + (c + 0.5f) * cellSize, boardRect.y + (r + i + 0.5f) * cellSize };
             return ch;
@@ -66,8 +78,8 @@ char ConnectFourGame::checkWinner() {
     }
     // Diagonal down-right
     for (int r = 0; r <= ROWS - 4; ++r) for (int c = 0; c <= COLS - 4; ++c) {
-        char ch = board[r][c]; if (ch == ' ') continue;
-        if (board[r + 1][c + 1] == ch && board[r + 2][c + 2] == ch && board[r + 3][c + 3] == ch) {
+        char ch = cellAt(r, c); if (ch == ' ') continue;
+        if (cellAt(r + 1, c + 1) == ch && cellAt(r + 2, c + 2) == ch && cellAt(r + 3, c + 3) == ch) {
             winningCount = 4;
             for (int i = 0; i < 4; ++i) winningPieces[i] = { boardRect.x + (c + i + 0.5f) * cellSize, boardRect.y + (r + i + 0.5f) * cellSize };
             return ch;
@@ -75,8 +87,8 @@ char ConnectFourGame::checkWinner() {
     }
     // Diagonal up-right
     for (int r = 3; r < ROWS; ++r) for (int c = 0; c <= COLS - 4; ++c) {
-        char ch = board[r][c]; if (ch == ' ') continue;
-        if (board[r - 1][c + 1] == ch && board[r - 2][c + 2] == ch && board[r - 3][c + 3] == ch) {
+        char ch = cellAt(r, c); if (ch == ' ') continue;
+        if (cellAt(r - 1, c + 1) == ch && cellAt(r - 2, c + 2) == ch && cellAt(r - 3, c + 3) == ch) {
             winningCount = 4;
             for (int i = 0; i < 4; ++i) winningPieces[i] = { boardRect.x + (c + i + 0.5f) * cellSize, boardRect.y + (r - i + 0.5f) * cellSize };
             return ch;
@@ -109,7 +121,7 @@ void ConnectFourGame::update(GameState& stateOut) {
         if (animationPos.y >= targetY) {
             animationPos.y = targetY;
             // finalize placement
-            board[animTargetRow][animTargetCol] = animPiece;
+            position.play(animTargetCol);
             isAnimating = false;
             // check winner/draw
             char w = checkWinner();
@@ -145,110 +157,236 @@ void ConnectFourGame::update(GameState& stateOut) {
     }
 }
 
-static int scoreCount(int countSelf, int countOpp, int countEmpty) {
-    if (countSelf == 4) return 100000;
-    if (countSelf == 3 && countEmpty == 1) return 100;
-    if (countSelf == 2 && countEmpty == 2) return 10;
-    if (countOpp == 3 && countEmpty == 1) return -120; // prioritize blocking
-    if (countOpp == 2 && countEmpty == 2) return -8;
-    return 0;
+// Table scores are 16-bit. Evaluations stay within about +-10000; a forced win or loss is
+// stored as its distance from the node so it can be re-rooted at any ply.
+static int scoreToTT(int score, int depth) {
+    if (score > 900000) return 32767 - (ConnectFourGame::WIN_SCORE - score - depth);
+    if (score < -900000) return -32767 + (ConnectFourGame::WIN_SCORE + score - depth);
+    return score;
 }
 
-int ConnectFourGame::evaluateWindow(int r0, int c0, int dr, int dc) const {
-    int r = r0, c = c0;
-    int cntR = 0, cntY = 0, cntE = 0;
-    for (int i = 0; i < 4; ++i) {
-        char ch = board[r][c];
-        if (ch == 'R') ++cntR; else if (ch == 'Y') ++cntY; else ++cntE;
-        r += dr; c += dc;
-    }
-    return scoreCount(cntR, cntY, cntE) - scoreCount(cntY, cntR, cntE) / 10; // small asymmetry
+static int scoreFromTT(int score, int depth) {
+    if (score > 30000) return ConnectFourGame::WIN_SCORE - depth - (32767 - score);
+    if (score < -30000) return -ConnectFourGame::WIN_SCORE + depth + (32767 + score);
+    return score;
 }
 
-int ConnectFourGame::evaluateBoard() const {
-    int score = 0;
-    // Center column preference
-    int center = COLS / 2;
-    int centerCountR = 0, centerCountY = 0;
-    for (int r = 0; r < ROWS; ++r) { if (board[r][center] == 'R') ++centerCountR; if (board[r][center] == 'Y') ++centerCountY; }
-    score += (centerCountR - centerCountY) * 6;
+// Copy-make: a child position is 24 bytes, so there is nothing to undo but the evaluation's
+// window counts, which are added and removed around each child
+int ConnectFourGame::minimax(const ConnectFourBoard& pos, int depth, int alpha, int beta, bool maximizing) {
+    ++searchNodes;
+    if (outOfTime()) return 0; // discarded: the root drops the whole iteration
+    // Only the side that just moved can have completed a line
+    if (pos.lastMoveWon()) return maximizing ? -WIN_SCORE + depth : WIN_SCORE - depth;
+    if (pos.full() || depth >= searchDepth) return eval.score(pos);
 
-    // Horizontal
-    for (int r = 0; r < ROWS; ++r) for (int c = 0; c <= COLS - 4; ++c) score += evaluateWindow(r, c, 0, 1);
-    // Vertical
-    for (int c = 0; c < COLS; ++c) for (int r = 0; r <= ROWS - 4; ++r) score += evaluateWindow(r, c, 1, 0);
-    // Diagonals
-    for (int r = 0; r <= ROWS - 4; ++r) for (int c = 0; c <= COLS - 4; ++c) score += evaluateWindow(r, c, 1, 1);
-    for (int r = 3; r < ROWS; ++r) for (int c = 0; c <= COLS - 4; ++c) score += evaluateWindow(r, c, -1, 1);
-    return score;
-}
+    // Threat masks settle the next two plies without expanding them, with the scores the full
+    // search would find: a win now, or every move handing the opponent one
+    if (pos.canWinNext()) return maximizing ? WIN_SCORE - depth - 1 : -WIN_SCORE + depth + 1;
+    uint64_t safe = pos.nonLosingMoves();
+    if (depth + 1 < searchDepth && safe == 0) return maximizing ? -WIN_SCORE + depth + 2 : WIN_SCORE - depth - 2;
 
-int ConnectFourGame::minimax(int depth, int alpha, int beta, bool maximizing) {
-    char w = checkWinner();
-    if (w == 'Y') return 1000000 - depth;
-    if (w == 'R') return -1000000 + depth;
-    if (isDraw() || depth >= getSearchDepth()) return evaluateBoard();
-
-    if (maximizing) {
-        int best = -10000000;
-        // Order by proximity to center
-        int order[7] = { 3,2,4,1,5,0,6 };
-        for (int k = 0; k < COLS; ++k) {
-            int c = order[k];
-            int r = lowestEmptyRow(c);
-            if (r == -1) continue;
-            board[r][c] = 'Y';
-            int val = minimax(depth + 1, alpha, beta, false);
-            board[r][c] = ' ';
-            best = std::max(best, val);
-            alpha = std::max(alpha, best);
-            if (beta <= alpha) break;
+    int remaining = searchDepth - depth;
+    ConnectFourTT::Key key;
+    int ttColumn = -1;
+    if (table) {
+        key = ConnectFourTT::keyOf(pos);
+        ConnectFourTTEntry e;
+        ++ttProbes;
+        if (table->probe(key, e)) {
+            ++ttHits;
+            ttColumn = e.column;
+            if (e.depth >= remaining) {
+                int s = scoreFromTT(e.score, depth);
+                if (e.bound == TTBound::EXACT) return s;
+                if (e.bound == TTBound::LOWER && s >= beta) return s;
+                if (e.bound == TTBound::UPPER && s <= alpha) return s;
+            }
         }
-        return best;
     }
-    else {
-        int best = 10000000;
-        int order[7] = { 3,2,4,1,5,0,6 };
-        for (int k = 0; k < COLS; ++k) {
-            int c = order[k];
-            int r = lowestEmptyRow(c);
-            if (r == -1) continue;
-            board[r][c] = 'R';
-            int val = minimax(depth + 1, alpha, beta, true);
-            board[r][c] = ' ';
-            best = std::min(best, val);
-            beta = std::min(beta, best);
-            if (beta <= alpha) break;
+
+    int order[COLS], n = orderMoves(pos, safe, ttColumn, depth, maximizing, order);
+    int alphaOrig = alpha, betaOrig = beta;
+    int best = maximizing ? -10000000 : 10000000;
+    int bestCol = -1;
+    // On the last ply the children are leaves, scored a SIMD batch at a time (so a cutoff on the
+    // first ones skips the rest) with the values and node counts the recursive calls would give
+    uint64_t moves[COLS];
+    int leafScores[COLS];
+    bool leafWon[COLS];
+    bool leaves = remaining == 1 && leafKernel != ConnectFourLeaves::Kernel::SCALAR;
+    int lanes = ConnectFourLeaves::lanes(leafKernel);
+    for (int k = 0; k < n; ++k) moves[k] = pos.dropCell(order[k]);
+    for (int k = 0; k < n; ++k) {
+        int c = order[k];
+        uint64_t move = moves[k];
+        int val;
+        if (leaves) {
+            if (k % lanes == 0) ConnectFourLeaves::evaluate(leafKernel, pos, moves + k, std::min(lanes, n - k), leafScores + k, leafWon + k);
+            ++searchNodes;
+            if (outOfTime()) return 0;
+            val = !leafWon[k] ? leafScores[k] : maximizing ? WIN_SCORE - depth - 1 : -WIN_SCORE + depth + 1;
+        }
+        else {
+            ConnectFourBoard child = pos;
+            child.play(move);
+            eval.add(move, maximizing); // Yellow maximizes
+            val = minimax(child, depth + 1, alpha, beta, !maximizing);
+            eval.remove(move, maximizing);
+            if (aborted) return 0;
+        }
+        if (maximizing ? val > best : val < best) { best = val; bestCol = c; }
+        if (maximizing) alpha = std::max(alpha, best);
+        else beta = std::min(beta, best);
+        if (beta <= alpha) {
+            if (killers[depth][0] != c) { killers[depth][1] = killers[depth][0]; killers[depth][0] = c; }
+            history[maximizing][ConnectFourBoard::lowestBit(move)] += remaining * remaining;
+            break;
         }
-        return best;
     }
+
+    if (table) {
+        TTBound bound = (best <= alphaOrig) ? TTBound::UPPER : (best >= betaOrig) ? TTBound::LOWER : TTBound::EXACT;
+        table->store(key, remaining, scoreToTT(best, depth), bound, bestCol);
+    }
+    return best;
+}
+
+// Columns worth searching at `pos`, best first; returns how many. Wins never get here (the
+// threat cutoffs settle them), and `moves` is pos.nonLosingMoves(): a forced block is the only
+// move, and moves that hand the opponent a win are dropped unless every move does. The rest go
+// by the threats they create (except next to the horizon, where counting them costs more than it
+// saves), then the table move, the killers and history, and center-out among equals.
+int ConnectFourGame::orderMoves(const ConnectFourBoard& pos, uint64_t moves, int ttColumn, int depth, bool maximizing, int* order) const {
+    int n = 0;
+    if (!dynamicOrdering) {
+        if (ttColumn >= 0 && pos.canPlay(ttColumn)) order[n++] = ttColumn;
+        for (int c : ConnectFourBoard::CENTER_ORDER) if (c != ttColumn && pos.canPlay(c)) order[n++] = c;
+        return n;
+    }
+    if (!moves) moves = pos.playable();
+    bool countThreats = searchDepth - depth > 1;
+    int threatsBefore = countThreats ? ConnectFourBoard::popCount(pos.threats()) : 0;
+    int keys[COLS];
+    for (int c : ConnectFourBoard::CENTER_ORDER) {
+        uint64_t move = moves & ConnectFourBoard::columnMask(c);
+        if (!move) continue;
+        int key = countThreats ? (pos.threatCount(move) - threatsBefore) << 20 : 0;
+        if (c == ttColumn) key += 1 << 19;
+        else if (c == killers[depth][0]) key += 1 << 18;
+        else if (c == killers[depth][1]) key += 1 << 17;
+        key += std::min(history[maximizing][ConnectFourBoard::lowestBit(move)], (1 << 17) - 1);
+        int i = n++;
+        for (; i > 0 && keys[i - 1] < key; --i) { keys[i] = keys[i - 1]; order[i] = order[i - 1]; }
+        keys[i] = key;
+        order[i] = c;
+    }
+    return n;
 }
 
 int ConnectFourGame::aiChooseColumn() {
     // Easy: random valid column
     if (difficulty == GameDifficulty::EASY) {
         int cols[COLS]; int n = 0;
-        for (int c = 0; c < COLS; ++c) if (lowestEmptyRow(c) != -1) cols[n++] = c;
+        for (int c = 0; c < COLS; ++c) if (position.canPlay(c)) cols[n++] = c;
         if (n == 0) return -1;
         return cols[GetRandomValue(0, n - 1)];
     }
 
-    // Medium/Hard: minimax with depth based on difficulty
-    int bestVal = -10000000;
+    // The search runs on the UI thread, so the whole move shares one budget
+    double budget = getMoveBudget();
+
+    // Hard: perfect play whenever the position solves within most of the budget; openings
+    // come straight from the book when one is loaded
+    if (difficulty == GameDifficulty::HARD && solver) {
+        auto start = std::chrono::steady_clock::now();
+        solver->setTimeLimit(budget * 0.7);
+        ConnectFourSolution solution = solver->bestMove(position);
+        if (solution.solved) return solution.column;
+        budget -= std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Medium (and Hard when unsolved): alpha-beta deepened within what is left, or tree search
+    if (engine == ConnectFourEngine::MCTS) return mctsColumn(std::max(budget, 0.01));
+    return timedColumn(getSearchDepth(), budget);
+}
+
+// Tree search for `seconds`; the tree under the reply is kept for the next move
+int ConnectFourGame::mctsColumn(double seconds) {
+    if (!mcts) {
+        mcts = std::make_shared<ConnectFourMCTS>();
+        mcts->setThreads(CpuTopology::system().threadsFor(ThreadPlacement{}));
+    }
+    mcts->setTimeLimit(seconds);
+    return mcts->search(position).column;
+}
+
+void ConnectFourGame::prepareSearch() {
+    if (table) table->newSearch();
+    // Killers are per move; history carries over, halved
+    for (auto& k : killers) k[0] = k[1] = -1;
+    for (auto& side : history) for (int& h : side) h /= 2;
+    timed = aborted = false;
+}
+
+// Only reads the clock every 1024 nodes
+bool ConnectFourGame::outOfTime() {
+    if (timed && (searchNodes & 1023) == 0 && std::chrono::steady_clock::now() >= deadline) aborted = true;
+    return aborted;
+}
+
+// One full-width root search to `depth`, trying `firstCol` first; meaningless once aborted
+int ConnectFourGame::searchRoot(int depth, int firstCol, int& bestVal) {
+    searchDepth = depth;
+    eval.reset(position);
+    int order[COLS + 1], n = 0;
+    if (firstCol >= 0) order[n++] = firstCol;
+    for (int c : ConnectFourBoard::CENTER_ORDER) if (c != firstCol) order[n++] = c;
+    bestVal = -10000000;
     int bestCol = -1;
-    int order[7] = { 3,2,4,1,5,0,6 };
-    for (int k = 0; k < COLS; ++k) {
+    for (int k = 0; k < n; ++k) {
         int c = order[k];
-        int r = lowestEmptyRow(c);
-        if (r == -1) continue;
-        board[r][c] = 'Y';
-        int val = minimax(0, -10000000, 10000000, false);
-        board[r][c] = ' ';
+        if (!position.canPlay(c)) continue;
+        uint64_t move = position.dropCell(c);
+        ConnectFourBoard child = position;
+        child.play(move);
+        eval.add(move, true);
+        int val = minimax(child, 0, bestVal, 10000000, false); // only a better move needs an exact score
+        eval.remove(move, true);
+        if (aborted) return -1;
         if (val > bestVal) { bestVal = val; bestCol = c; }
     }
     return bestCol;
 }
 
+int ConnectFourGame::bestColumn(int depth) {
+    prepareSearch();
+    int bestVal;
+    return searchRoot(depth, -1, bestVal);
+}
+
+// Iterative deepening: depths up to `minDepth` always complete, deeper ones until `seconds` run
+// out, each trying the previous best column first. Returns the deepest completed iteration's
+// column, and stops early once a forced win or loss is found or the whole game tree is searched.
+int ConnectFourGame::timedColumn(int minDepth, double seconds) {
+    prepareSearch();
+    deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    int bestCol = -1;
+    completedDepth = 0;
+    int empty = ConnectFourBoard::CELLS - position.moves;
+    for (int depth = 1; depth <= empty; ++depth) {
+        timed = depth > minDepth;
+        int val;
+        int col = searchRoot(depth, bestCol, val);
+        if (aborted) break;
+        bestCol = col;
+        completedDepth = depth;
+        if (val > 900000 || val < -900000) break;
+        if (timed && std::chrono::steady_clock::now() >= deadline) break;
+    }
+    return bestCol;
+}
+
 void ConnectFourGame::draw() const {
     // Board frame
     Color boardCol = { 30, 60, 130, 255 };
@@ -267,7 +405,7 @@ void ConnectFourGame::draw() const {
         float cx = boardRect.x + c * cellSize + cellSize * 0.5f;
         float cy = boardRect.y + r * cellSize + cellSize * 0.5f;
         float rad = cellSize * 0.38f;
-        char ch = board[r][c];
+        char ch = cellAt(r, c);
         if (ch == ' ') {
             DrawCircle((int)cx, (int)cy, rad, holeCol);
         }
@@ -1,21 +1,42 @@
 #pragma once
 #include "raylib.h"
-#include <array>
+#include "ConnectFourBoard.h"
+#include "ConnectFourEval.h"
+#include "ConnectFourLeaves.h"
+#include "ConnectFourMCTS.h"
+#include "ConnectFourSolver.h"
+#include "ConnectFourTT.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include "Menu.h" // GameState enum
 #include "globals.h"
 
+// Search behind MEDIUM, and HARD when the solver runs out of time
+enum class ConnectFourEngine {
+    ALPHA_BETA,
+    MCTS,
+};
+
 class ConnectFourGame {
+    friend struct ConnectFourBench;
+
 public:
     void init(int screenWidth, int screenHeight);
     void update(GameState& stateOut);
     void draw() const;
     void setFont(Font f) { uiFont = f; }
     void setDifficulty(GameDifficulty d) { difficulty = d; }
+    void setEngine(ConnectFourEngine e) { engine = e; }
+    bool loadOpeningBook(const std::string& path); // HARD reads solved openings from it
+
+    static constexpr int WIN_SCORE = 1000000; // minus the ply of the winning move
 
 private:
-    static constexpr int ROWS = 6;
-    static constexpr int COLS = 7;
-    std::array<std::array<char, COLS>, ROWS> board{}; // ' ', 'R' (human), 'Y' (AI)
+    static constexpr int ROWS = ConnectFourBoard::ROWS;
+    static constexpr int COLS = ConnectFourBoard::COLS;
+    ConnectFourBoard position; // 'R' (human) moves first, 'Y' (AI) second
     Rectangle boardRect{ 0,0,0,0 };
     float cellSize = 0.0f;
     bool gameOver = false;
@@ -42,21 +63,51 @@ private:
     mutable Vector2 winningPieces[4]{};
 
     GameDifficulty difficulty = GameDifficulty::HARD;
+    ConnectFourEngine engine = ConnectFourEngine::ALPHA_BETA;
+    // Depth every search completes, and the time it may keep deepening for
     int getSearchDepth() const { return (difficulty == GameDifficulty::EASY) ? 2 : (difficulty == GameDifficulty::MEDIUM) ? 4 : 5; }
+    double getTimeBudget() const { return (difficulty == GameDifficulty::HARD) ? 0.5 : 0.1; }
+    // Whole thinking time of one AI move, HARD's solver included
+    double getMoveBudget() const {
+        if (engine == ConnectFourEngine::MCTS) return (difficulty == GameDifficulty::MEDIUM) ? 0.25 : 1.0;
+        return getTimeBudget();
+    }
 
     void reset();
+    char cellAt(int row, int col) const; // ' ', 'R' or 'Y'; row 0 = top
     int lowestEmptyRow(int col) const; // -1 if column full
-    bool dropPiece(int col, char who);
     bool hasMoves() const;
     char checkWinner(); // 'R', 'Y', or ' '
     bool isDraw() ;
     int columnFromMouse(Vector2 m) const;
 
     // AI helpers
+    std::shared_ptr<ConnectFourTT> table; // created in init(), kept across moves
+    std::shared_ptr<ConnectFourSolver> solver; // HARD; created in init()
+    std::shared_ptr<ConnectFourBook> book;
+    std::shared_ptr<ConnectFourMCTS> mcts; // created on first use, its tree kept across moves
+    ConnectFourEval eval; // leaf scores, updated move by move during the search
+    ConnectFourLeaves::Kernel leafKernel = ConnectFourLeaves::best(); // last-ply batch scoring; SCALAR keeps it incremental
+    int searchDepth = 0;
+    uint64_t searchNodes = 0;
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;                  // probes that found the position
+    bool dynamicOrdering = true; // off: table move, then center-out (kept for the ordering benchmark)
+    int killers[ConnectFourBoard::CELLS + 1][2]; // by ply, the last two columns that cut off
+    int history[2][ConnectFourBoard::H1 * COLS]{}; // by side (Yellow = 1) and cell, cutoffs weighted by depth
     int aiChooseColumn();
-    int minimax(int depth, int alpha, int beta, bool maximizing);
-    int evaluateBoard() const;
-    int evaluateWindow(int r0, int c0, int dr, int dc) const; // window of 4
+    std::chrono::steady_clock::time_point deadline;
+    bool timed = false;   // deadline applies to the current iteration
+    bool aborted = false; // deadline passed; the iteration is discarded
+    int completedDepth = 0; // of the last timedColumn()
+    void prepareSearch();
+    bool outOfTime();
+    int searchRoot(int depth, int firstCol, int& bestVal);
+    int bestColumn(int depth); // fixed depth, no deadline
+    int timedColumn(int minDepth, double seconds);
+    int mctsColumn(double seconds);
+    int minimax(const ConnectFourBoard& pos, int depth, int alpha, int beta, bool maximizing);
+    int orderMoves(const ConnectFourBoard& pos, uint64_t moves, int ttColumn, int depth, bool maximizing, int* order) const;
 };
 
 
@@ -0,0 +1,249 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Boards wider than 64 bits (with the sentinel row) need a 128-bit integer; MSVC has none, so
+// there only boards up to 64 bits are available
+#if defined(__SIZEOF_INT128__)
+#define CONNECTN_WIDE_BOARDS 1
+using ConnectNWideBits = unsigned __int128;
+#else
+#define CONNECTN_WIDE_BOARDS 0
+struct ConnectNWideBits; // never defined
+#endif
+
+namespace connectn {
+    // One bit per column at `row`: 1 + 2^H1 + 2^(2*H1) + ... shifted up
+    template <class Bits>
+    constexpr Bits rowMask(int h1, int cols, int row) {
+        Bits b = 0;
+        for (int c = 0; c < cols; ++c) b |= (Bits)1 << (c * h1 + row);
+        return b;
+    }
+    // Center column first, then alternately outwards (left first when the board has a middle)
+    template <int Cols>
+    constexpr std::array<int, Cols> centerOrder() {
+        std::array<int, Cols> order{};
+        int center = (Cols - 1) / 2;
+        for (int i = 0; i < Cols; ++i) {
+            int step = (i + 1) / 2;
+            bool right = (i % 2 == 1) == (Cols % 2 == 0);
+            order[i] = i == 0 ? center : right ? center + step : center - step;
+        }
+        return order;
+    }
+}
+
+// Connect-N position as two bitboards, for any board that fits 128 bits. Each column takes
+// Rows + 1 bits, bottom cell first; the extra bit above every column is a sentinel that stays
+// empty, so the shift-and alignment tests never carry from one column into the next. `current`
+// holds the stones of the side to move and `mask` every occupied cell: a move is a single
+// addition and the colors swap by xor. The word is 64 bits whenever the board fits.
+template <int Rows, int Cols, int Win>
+struct ConnectNBoard {
+    static constexpr int ROWS = Rows;
+    static constexpr int COLS = Cols;
+    static constexpr int WIN = Win;
+    static constexpr int H1 = ROWS + 1;
+    static constexpr int CELLS = ROWS * COLS;
+    static constexpr bool WIDE = H1 * COLS > 64;
+    static_assert(WIN >= 2 && WIN <= ROWS && WIN <= COLS, "win length must fit the board");
+    static_assert(H1 * COLS <= 128, "board must fit in 128 bits");
+    static_assert(!WIDE || CONNECTN_WIDE_BOARDS, "boards over 64 bits need 128-bit integers");
+    using Bits = std::conditional_t<WIDE, ConnectNWideBits, uint64_t>;
+
+    static constexpr Bits ONE = 1;
+    static constexpr Bits bottomMask(int col) { return ONE << (col * H1); }
+    static constexpr Bits topMask(int col) { return ONE << (ROWS - 1 + col * H1); }
+    static constexpr Bits columnMask(int col) { return ((ONE << ROWS) - 1) << (col * H1); }
+    // Bitboard cell for a screen row (0 = top) and column
+    static constexpr Bits cellMask(int row, int col) { return ONE << (col * H1 + ROWS - 1 - row); }
+
+    static constexpr Bits BOTTOM = connectn::rowMask<Bits>(H1, COLS, 0);
+    static constexpr Bits FULL = BOTTOM * ((ONE << ROWS) - 1);
+    static constexpr std::array<int, COLS> CENTER_ORDER = connectn::centerOrder<COLS>();
+
+    static int popCount(uint64_t b) {
+#if defined(_MSC_VER)
+        return (int)__popcnt64(b);
+#else
+        return __builtin_popcountll(b);
+#endif
+    }
+    static int lowestBit(uint64_t b) { // b != 0
+#if defined(_MSC_VER)
+        unsigned long i;
+        _BitScanForward64(&i, b);
+        return (int)i;
+#else
+        return __builtin_ctzll(b);
+#endif
+    }
+#if CONNECTN_WIDE_BOARDS
+    static int popCount(ConnectNWideBits b) { return popCount((uint64_t)b) + popCount((uint64_t)(b >> 64)); }
+    static int lowestBit(ConnectNWideBits b) { return (uint64_t)b ? lowestBit((uint64_t)b) : 64 + lowestBit((uint64_t)(b >> 64)); }
+#endif
+
+    // The loops over the win length below are unrolled at compile time (recursion and folds
+    // over index sequences): left to the optimizer they are not, and cost over half the speed.
+
+    // `b` shifted by d steps along `shift`, toward lower bits for positive d
+    template <int D>
+    static constexpr Bits step(Bits b, int shift) {
+        if constexpr (D > 0) return b >> (D * shift);
+        else if constexpr (D < 0) return b << (-D * shift);
+        else return ~(Bits)0;
+    }
+
+    // Starts of runs of WIN along `shift`: runs of 2, 4, ... by doubling, then one
+    // overlapping step for the rest
+    template <int Run = 1>
+    static constexpr Bits runs(Bits m, int shift) {
+        if constexpr (Run * 2 <= WIN) return runs<Run * 2>(m & (m >> (Run * shift)), shift);
+        else if constexpr (Run < WIN) return m & (m >> ((WIN - Run) * shift));
+        else return m;
+    }
+    // True if the stones in `b` contain WIN in a row along `shift`
+    static constexpr bool aligned(Bits b, int shift) { return runs(b, shift) != 0; }
+    // Vertical, horizontal and both diagonals
+    static constexpr bool alignment(Bits b) {
+        return aligned(b, 1) || aligned(b, H1) || aligned(b, H1 - 1) || aligned(b, H1 + 1);
+    }
+
+    // Cells with WIN - 1 of `stones` around them along `shift`, in any of the WIN positions
+    template <int Gap, std::size_t... I>
+    static constexpr Bits around(Bits stones, int shift, std::index_sequence<I...>) {
+        return (step<(int)I - Gap>(stones, shift) & ...);
+    }
+    template <std::size_t... Gap>
+    static constexpr Bits completions(Bits stones, int shift, std::index_sequence<Gap...>) {
+        return (around<(int)Gap>(stones, shift, std::make_index_sequence<WIN>{}) | ...);
+    }
+    static constexpr Bits completions(Bits stones, int shift) {
+        return completions(stones, shift, std::make_index_sequence<WIN>{});
+    }
+    template <std::size_t... I>
+    static constexpr Bits below(Bits stones, std::index_sequence<I...>) { return ((stones << (I + 1)) & ...); }
+    // Empty cells that would complete a line of WIN for `stones`
+    static constexpr Bits winningCells(Bits stones, Bits mask) {
+        Bits vertical = below(stones, std::make_index_sequence<WIN - 1>{}); // only ever on top
+        Bits r = vertical | completions(stones, H1) | completions(stones, H1 - 1) | completions(stones, H1 + 1);
+        return r & (FULL ^ mask);
+    }
+
+    // Windows of WIN along `shift` that hold none of `other`'s stones, with how many of `own`'s
+    // stones they hold. Bit i stands for the window starting at cell i; off-board cells and the
+    // sentinel row are never open, so no window wraps. The counts are bit-sliced over all windows
+    // at once: an adder tree for four, a ripple counter otherwise.
+    struct LineCounts {
+        Bits windows = 0;
+        Bits count[3] = {}; // binary digits, low first
+        constexpr Bits holding(int n) const {
+            return windows & ((n & 1) ? count[0] : ~count[0]) & ((n & 2) ? count[1] : ~count[1]) & ((n & 4) ? count[2] : ~count[2]);
+        }
+    };
+    static_assert(WIN < 8, "window counts are three bits");
+    template <std::size_t... I>
+    static constexpr void countWindows(LineCounts& n, Bits own, Bits open, int shift, std::index_sequence<I...>) {
+        n.windows = ((open >> (I * shift)) & ...);
+        auto add = [&n](Bits carry) {
+            Bits next = n.count[0] & carry;
+            n.count[0] ^= carry;
+            n.count[2] ^= n.count[1] & next;
+            n.count[1] ^= next;
+        };
+        (add(own >> (I * shift)), ...);
+    }
+    static constexpr LineCounts lines(Bits own, Bits other, int shift) {
+        LineCounts n;
+        Bits open = ~other & FULL;
+        if constexpr (WIN == 4) {
+            n.windows = open & (open >> shift) & (open >> (2 * shift)) & (open >> (3 * shift));
+            Bits a = own, b = own >> shift, c = own >> (2 * shift), d = own >> (3 * shift);
+            Bits s1 = a ^ b, c1 = a & b, s2 = c ^ d, c2 = c & d;
+            Bits carry = s1 & s2;
+            n.count[0] = s1 ^ s2;
+            n.count[1] = c1 ^ c2 ^ carry;
+            n.count[2] = (c1 & c2) | (c1 & carry) | (c2 & carry);
+        }
+        else {
+            countWindows(n, own, open, shift, std::make_index_sequence<WIN>{});
+        }
+        return n;
+    }
+
+    // Swaps columns left to right. Works on keys too: a key column never carries into the next.
+    static constexpr Bits mirror(Bits b) {
+        Bits m = 0;
+        for (int c = 0; c < COLS; ++c) m |= ((b >> (c * H1)) & ((ONE << H1) - 1)) << ((COLS - 1 - c) * H1);
+        return m;
+    }
+
+    Bits current = 0; // side to move
+    Bits mask = 0;    // both sides
+    int moves = 0;
+
+    bool canPlay(int col) const { return (mask & topMask(col)) == 0; }
+    int height(int col) const { return popCount(mask & columnMask(col)); }
+    bool full() const { return moves == CELLS; }
+    // Unique per position: each column's stones plus its height bit
+    Bits key() const { return current + mask; }
+    Bits opponent() const { return current ^ mask; } // the side that just moved
+    bool lastMoveWon() const { return alignment(opponent()); }
+    // Cells a move can go into, one per non-full column
+    Bits playable() const { return (mask + BOTTOM) & FULL; }
+
+    // Cell a stone dropped into `col` lands on
+    Bits dropCell(int col) const { return (mask + bottomMask(col)) & columnMask(col); }
+    void play(int col) { play(dropCell(col)); }
+    void play(Bits move) { // one bit from playable()
+        current ^= mask;
+        mask |= move;
+        ++moves;
+    }
+    bool isWinningMove(int col) const {
+        return alignment(current | dropCell(col));
+    }
+
+    // Threats: empty cells where a stone would complete a line, for the side to move and the other
+    Bits threats() const { return winningCells(current, mask); }
+    Bits opponentThreats() const { return winningCells(opponent(), mask); }
+    bool canWinNext() const { return (threats() & playable()) != 0; }
+    // Moves that do not let the opponent win next turn (only meaningful when !canWinNext()):
+    // a forced block if there is exactly one, nothing if there are two, and never a move
+    // directly below an opponent threat
+    Bits nonLosingMoves() const {
+        Bits moves = playable(), threat = opponentThreats();
+        Bits forced = moves & threat;
+        if (forced) {
+            if (forced & (forced - 1)) return 0;
+            moves = forced;
+        }
+        return moves & ~(threat >> 1);
+    }
+    // Threats the side to move would have after `move`, for move ordering
+    int threatCount(Bits move) const { return popCount(winningCells(current | move, mask)); }
+
+    // Stones of the first player (Red) and the second (Yellow)
+    Bits firstPlayer() const { return (moves & 1) ? opponent() : current; }
+    Bits secondPlayer() const { return (moves & 1) ? current : opponent(); }
+};
+
+// The game's board, and the larger ones the solver is also built for
+using ConnectFourBoard = ConnectNBoard<6, 7, 4>;
+using ConnectFour7x8Board = ConnectNBoard<7, 8, 4>;
+#if CONNECTN_WIDE_BOARDS
+using ConnectFour8x9Board = ConnectNBoard<8, 9, 4>;
+using ConnectFive8x9Board = ConnectNBoard<8, 9, 5>;
+#endif
+
+static_assert(ConnectFourBoard::alignment(0xFULL) && !ConnectFourBoard::alignment(0x7ULL | (1ULL << 4)), "vertical four");
+static_assert(ConnectFourBoard::CENTER_ORDER[0] == 3 && ConnectFourBoard::CENTER_ORDER[1] == 2 && ConnectFourBoard::CENTER_ORDER[6] == 6, "center-out");
+static_assert(ConnectFour7x8Board::CENTER_ORDER[0] == 3 && ConnectFour7x8Board::CENTER_ORDER[1] == 4, "center-out, even width");
+static_assert(ConnectFour7x8Board::BOTTOM >> 56 == 1 && !ConnectFour7x8Board::WIDE, "7x8 fills 64 bits");
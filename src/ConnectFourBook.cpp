@@ -0,0 +1,222 @@
+#include "ConnectFourBook.h"
+#include "ConnectFourSolver.h"
+#include "ConnectFourTT.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+    const char kBookMagic[8] = { 'S', 'G', 'M', 'C', '4', 'B', 'K', '\0' };
+    const uint32_t kBookVersion = 1;
+
+    struct BookHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t ply;
+        uint64_t count;
+        uint64_t checksum; // FNV-1a over the records
+    };
+
+    uint64_t checksumOf(const uint64_t* records, size_t count) {
+        const unsigned char* p = (const unsigned char*)records;
+        uint64_t h = 0xCBF29CE484222325ULL;
+        for (size_t i = 0; i < count * sizeof(uint64_t); ++i) h = (h ^ p[i]) * 0x100000001B3ULL;
+        return h;
+    }
+
+    uint64_t record(uint64_t key, int score) { return (key << 8) | (uint64_t)(score + 64); }
+    int scoreOf(uint64_t rec) { return (int)(rec & 0xFF) - 64; }
+
+    // Canonical positions of one ply with their scores, for backing up the ply above
+    struct Level {
+        std::vector<ConnectFourBoard> positions;
+        std::vector<uint64_t> keys; // sorted canonical keys, parallel to positions
+        std::vector<int> scores;
+
+        int find(uint64_t key) const {
+            auto it = std::lower_bound(keys.begin(), keys.end(), key);
+            return (it != keys.end() && *it == key) ? (int)(it - keys.begin()) : -1;
+        }
+    };
+
+    void sortUnique(Level& level) {
+        std::vector<std::pair<uint64_t, ConnectFourBoard>> all;
+        all.reserve(level.positions.size());
+        for (const ConnectFourBoard& p : level.positions) all.emplace_back(ConnectFourTT::keyOf(p).key, p);
+        std::sort(all.begin(), all.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        all.erase(std::unique(all.begin(), all.end(), [](const auto& a, const auto& b) { return a.first == b.first; }), all.end());
+        level.positions.clear();
+        level.keys.clear();
+        for (const auto& e : all) { level.keys.push_back(e.first); level.positions.push_back(e.second); }
+    }
+}
+
+bool ConnectFourBook::open(const std::string& path) {
+    close();
+    if (!file.open(path) || file.size() < sizeof(BookHeader)) { file.close(); return false; }
+
+    const BookHeader* header = (const BookHeader*)file.data();
+    const uint64_t* body = (const uint64_t*)(header + 1);
+    bool valid = memcmp(header->magic, kBookMagic, sizeof(kBookMagic)) == 0
+        && header->version == kBookVersion
+        && header->ply <= (uint32_t)ConnectFourSolver::CELLS
+        && file.size() == sizeof(BookHeader) + header->count * sizeof(uint64_t)
+        && header->checksum == checksumOf(body, (size_t)header->count);
+    if (!valid) { close(); return false; }
+    records = body;
+    count = (size_t)header->count;
+    maxPly = (int)header->ply;
+    return true;
+}
+
+void ConnectFourBook::close() {
+    file.close();
+    records = nullptr;
+    count = 0;
+    maxPly = -1;
+}
+
+bool ConnectFourBook::probe(const ConnectFourBoard& pos, int& score) const {
+    if (pos.moves > maxPly) return false;
+    uint64_t key = ConnectFourTT::keyOf(pos).key;
+    const uint64_t* it = std::lower_bound(records, records + count, key, [](uint64_t r, uint64_t k) { return (r >> 8) < k; });
+    if (it == records + count || (*it >> 8) != key) return false;
+    score = scoreOf(*it);
+    return true;
+}
+
+bool ConnectFourBook::generate(const std::string& path, const ConnectFourBookOptions& options) {
+    const int cells = ConnectFourSolver::CELLS;
+    ConnectFourBoard root;
+    for (char ch : options.root) {
+        int col = ch - '1';
+        if (col < 0 || col >= ConnectFourBoard::COLS || !root.canPlay(col)) return false;
+        root.play(col);
+        if (root.lastMoveWon()) return false;
+    }
+    if (options.ply < root.moves || options.ply >= cells) return false;
+
+    // Unfinished positions ply by ply, folded by mirror symmetry
+    std::vector<Level> levels(1);
+    levels[0].positions.push_back(root);
+    sortUnique(levels[0]);
+    while (root.moves + (int)levels.size() - 1 < options.ply) {
+        Level next;
+        for (const ConnectFourBoard& pos : levels.back().positions) {
+            for (int col = 0; col < ConnectFourBoard::COLS; ++col) {
+                if (!pos.canPlay(col) || pos.isWinningMove(col)) continue;
+                ConnectFourBoard child = pos;
+                child.play(col);
+                next.positions.push_back(child);
+            }
+        }
+        sortUnique(next);
+        levels.push_back(std::move(next));
+    }
+
+    // The deepest ply is solved outright, one solver (and table) per worker
+    Level& deepest = levels.back();
+    deepest.scores.assign(deepest.positions.size(), 0);
+    int threads = options.threads > 0 ? options.threads : CpuTopology::system().threadsFor(options.placement);
+    threads = std::max(1, std::min(threads, (int)deepest.positions.size()));
+    std::atomic<size_t> nextIndex{ 0 };
+    std::atomic<size_t> done{ 0 };
+    auto t0 = std::chrono::steady_clock::now();
+    auto work = [&](int index) {
+        CpuTopology::placeWorker(index, threads, options.placement);
+        ConnectFourSolver solver;
+        for (;;) {
+            size_t i = nextIndex.fetch_add(1);
+            if (i >= deepest.positions.size()) break;
+            solver.solve(deepest.positions[i], deepest.scores[i]);
+            size_t finished = done.fetch_add(1) + 1;
+            if (options.progress && finished % std::max<size_t>(1, deepest.positions.size() / 100) == 0) {
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                printf("ply %d: %zu / %zu solved, %.1fs\n", options.ply, finished, deepest.positions.size(), seconds);
+                fflush(stdout);
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(work, t);
+    work(0);
+    for (auto& t : pool) t.join();
+
+    // Shallower plies by negamax over the ply below
+    for (int l = (int)levels.size() - 2; l >= 0; --l) {
+        Level& level = levels[l];
+        const Level& below = levels[l + 1];
+        level.scores.assign(level.positions.size(), 0);
+        for (size_t i = 0; i < level.positions.size(); ++i) {
+            const ConnectFourBoard& pos = level.positions[i];
+            if (pos.canWinNext()) { level.scores[i] = (cells + 1 - pos.moves) / 2; continue; }
+            int best = -cells;
+            for (int col = 0; col < ConnectFourBoard::COLS; ++col) {
+                if (!pos.canPlay(col)) continue;
+                ConnectFourBoard child = pos;
+                child.play(col);
+                int j = below.find(ConnectFourTT::keyOf(child).key);
+                if (j < 0) return false;
+                best = std::max(best, -below.scores[j]);
+            }
+            level.scores[i] = best;
+        }
+    }
+
+    std::vector<uint64_t> recs;
+    for (const Level& level : levels) {
+        for (size_t i = 0; i < level.keys.size(); ++i) recs.push_back(record(level.keys[i], level.scores[i]));
+    }
+    std::sort(recs.begin(), recs.end());
+
+    BookHeader header{};
+    memcpy(header.magic, kBookMagic, sizeof(kBookMagic));
+    header.version = kBookVersion;
+    header.ply = (uint32_t)options.ply;
+    header.count = recs.size();
+    header.checksum = checksumOf(recs.data(), recs.size());
+
+    // Written next to the target and renamed over it, so a crash never leaves a torn book
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+        && (recs.empty() || fwrite(recs.data(), sizeof(uint64_t), recs.size(), f) == recs.size());
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) { std::remove(tmp.c_str()); return false; }
+    std::remove(path.c_str());
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+int RunConnectFourBookTool(int argc, char** argv) {
+    // argv[0] is "--c4book"
+    ConnectFourBookOptions options;
+    options.progress = true;
+    std::string path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) options.threads = atoi(argv[++i]);
+        else if (arg == "--root" && i + 1 < argc) options.root = argv[++i];
+        else if (arg == "--pin") options.placement.pin = true;
+        else if (arg == "--smt") options.placement.skipSMT = false;
+        else if (path.empty()) path = arg;
+        else options.ply = atoi(argv[i]);
+    }
+    if (path.empty()) {
+        printf("usage: --c4book <out.book> [ply] [--threads N] [--root <columns>] [--pin] [--smt]\n");
+        return 2;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (!ConnectFourBook::generate(path, options)) { printf("book generation failed\n"); return 1; }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    ConnectFourBook book;
+    if (!book.open(path)) { printf("cannot read back %s\n", path.c_str()); return 1; }
+    printf("%zu positions up to ply %d in %.1fs\n", book.size(), book.ply(), seconds);
+    return 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "ConnectFourBoard.h"
+#include "CpuTopology.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct ConnectFourBookOptions {
+    int ply = 8;           // positions with up to this many stones
+    int threads = 0;       // 0 = CpuTopology::threadsFor(placement)
+    ThreadPlacement placement;
+    std::string root;      // columns (1-7) of a line to build the book under; empty = every opening
+    bool progress = false; // report solving progress on stdout
+};
+
+// Connect Four opening book: the exact score (as ConnectFourSolver::solve) of every unfinished
+// position with up to ply() stones, keyed on the mirror-folded key. The file is a checksummed
+// header followed by key-sorted 8-byte records (key << 8 | score + 64); it is memory-mapped and
+// binary-searched, so opening it costs nothing and a probe is a few cache misses.
+class ConnectFourBook {
+public:
+    bool open(const std::string& path); // a missing or mismatched file is ignored
+    void close();
+    bool isOpen() const { return records != nullptr; }
+    bool probe(const ConnectFourBoard& pos, int& score) const;
+    int ply() const { return maxPly; }
+    size_t size() const { return count; }
+
+    // Enumerates the canonical positions up to options.ply, solves the deepest ones on a thread
+    // pool, backs their scores up to the shallower plies and writes the book
+    static bool generate(const std::string& path, const ConnectFourBookOptions& options);
+
+private:
+    MappedFile file;
+    const uint64_t* records = nullptr;
+    size_t count = 0;
+    int maxPly = -1;
+};
+
+// Console front end: --c4book <out.book> [ply] [--threads N] [--root <columns>] [--pin] [--smt]
+int RunConnectFourBookTool(int argc, char** argv);
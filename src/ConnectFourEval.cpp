@@ -0,0 +1,135 @@
+#include "ConnectFourEval.h"
+#include <cstring>
+#include <initializer_list>
+
+namespace {
+    // For each bitboard cell, the windows through it
+    template <class Board>
+    struct WindowTables {
+        static constexpr int MAX_PER_CELL = 4 * Board::WIN;
+        int windows = 0;
+        uint8_t cellWindows[ConnectNEval<Board>::CELLS][MAX_PER_CELL] = {};
+        uint8_t cellCount[ConnectNEval<Board>::CELLS] = {};
+    };
+
+    template <class Board>
+    constexpr WindowTables<Board> buildWindows() {
+        WindowTables<Board> t;
+        const int dirs[4][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { 1, -1 } }; // (col, row) steps
+        int& n = t.windows;
+        for (const auto& d : dirs) {
+            for (int col = 0; col < Board::COLS; ++col) for (int row = 0; row < Board::ROWS; ++row) {
+                int endCol = col + (Board::WIN - 1) * d[0], endRow = row + (Board::WIN - 1) * d[1];
+                if (endCol >= Board::COLS || endRow < 0 || endRow >= Board::ROWS) continue;
+                for (int i = 0; i < Board::WIN; ++i) {
+                    int bit = (col + i * d[0]) * Board::H1 + row + i * d[1];
+                    t.cellWindows[bit][t.cellCount[bit]++] = (uint8_t)n;
+                }
+                ++n;
+            }
+        }
+        return t;
+    }
+    template <class Board>
+    constexpr WindowTables<Board> kWindows = buildWindows<Board>();
+    static_assert(kWindows<ConnectFourBoard>.windows == ConnectFourEval::WINDOWS, "69 windows on a 7x6 board");
+
+    // Window score by [red][yellow] stones, and what one more stone of either color adds
+    template <class Board>
+    struct WeightTables {
+        static constexpr int N = Board::WIN;
+        int score[N + 1][N + 1] = {};
+        int addRed[N][N + 1] = {}, addYellow[N + 1][N] = {};
+    };
+
+    template <class Board>
+    constexpr WeightTables<Board> buildWeights() {
+        constexpr int N = Board::WIN;
+        WeightTables<Board> t;
+        for (int r = 0; r <= N; ++r) for (int y = 0; r + y <= N; ++y) t.score[r][y] = ConnectNEval<Board>::windowScore(y, r);
+        for (int r = 0; r < N; ++r) for (int y = 0; r + y < N; ++y) {
+            t.addRed[r][y] = t.score[r + 1][y] - t.score[r][y];
+            t.addYellow[r][y] = t.score[r][y + 1] - t.score[r][y];
+        }
+        return t;
+    }
+    template <class Board>
+    constexpr WeightTables<Board> kWeights = buildWeights<Board>();
+    static_assert(kWeights<ConnectFourBoard>.score[1][0] == 0 && kWeights<ConnectFourBoard>.score[0][1] == 0, "single stones do not score");
+
+    // Windows holding both colors score nothing, so the board is scored per direction from the
+    // single-color windows, by how many stones they hold
+    template <class Board>
+    int scoreLines(typename Board::Bits own, typename Board::Bits other, const int* weight) {
+        int score = 0;
+        for (int shift : { 1, Board::H1, Board::H1 - 1, Board::H1 + 1 }) {
+            typename Board::LineCounts n = Board::lines(own, other, shift);
+            for (int k = 2; k <= Board::WIN; ++k) score += weight[k] * Board::popCount(n.holding(k));
+        }
+        return score;
+    }
+}
+
+template <class Board>
+int ConnectNEval<Board>::threatScore(const Board& pos) {
+    Bits red = Board::winningCells(pos.firstPlayer(), pos.mask) & ODD_ROWS;
+    Bits yellow = Board::winningCells(pos.secondPlayer(), pos.mask) & ~ODD_ROWS;
+    return (Board::popCount(yellow) - Board::popCount(red)) * THREAT_WEIGHT;
+}
+
+template <class Board>
+int ConnectNEval<Board>::scan(const Board& pos) {
+    const auto& weights = kWeights<Board>;
+    int yellowWeight[WIN + 1], redWeight[WIN + 1];
+    for (int k = 0; k <= WIN; ++k) { yellowWeight[k] = weights.score[0][k]; redWeight[k] = weights.score[k][0]; }
+    Bits red = pos.firstPlayer(), yellow = pos.secondPlayer();
+    // Center column preference
+    Bits center = Board::columnMask(COLS / 2);
+    int score = (Board::popCount(yellow & center) - Board::popCount(red & center)) * CENTER_WEIGHT;
+    return score + scoreLines<Board>(yellow, red, yellowWeight) + scoreLines<Board>(red, yellow, redWeight) + threatScore(pos);
+}
+
+template <class Board>
+void ConnectNEval<Board>::reset(const Board& pos) {
+    memset(count, 0, sizeof(count));
+    total = 0;
+    for (Bits b = pos.firstPlayer(); b; b &= b - 1) add(b & (0 - b), false);
+    for (Bits b = pos.secondPlayer(); b; b &= b - 1) add(b & (0 - b), true);
+}
+
+template <class Board>
+void ConnectNEval<Board>::add(Bits move, bool yellow) {
+    const auto& windows = kWindows<Board>;
+    const auto& weights = kWeights<Board>;
+    int bit = Board::lowestBit(move);
+    uint8_t* red = count[0];
+    uint8_t* yel = count[1];
+    for (int i = 0; i < windows.cellCount[bit]; ++i) {
+        int w = windows.cellWindows[bit][i];
+        if (yellow) total += weights.addYellow[red[w]][yel[w]++];
+        else total += weights.addRed[red[w]++][yel[w]];
+    }
+    if (bit / Board::H1 == COLS / 2) total += yellow ? CENTER_WEIGHT : -CENTER_WEIGHT;
+}
+
+template <class Board>
+void ConnectNEval<Board>::remove(Bits move, bool yellow) {
+    const auto& windows = kWindows<Board>;
+    const auto& weights = kWeights<Board>;
+    int bit = Board::lowestBit(move);
+    uint8_t* red = count[0];
+    uint8_t* yel = count[1];
+    for (int i = 0; i < windows.cellCount[bit]; ++i) {
+        int w = windows.cellWindows[bit][i];
+        if (yellow) total -= weights.addYellow[red[w]][--yel[w]];
+        else total -= weights.addRed[--red[w]][yel[w]];
+    }
+    if (bit / Board::H1 == COLS / 2) total -= yellow ? CENTER_WEIGHT : -CENTER_WEIGHT;
+}
+
+template class ConnectNEval<ConnectFourBoard>;
+template class ConnectNEval<ConnectFour7x8Board>;
+#if CONNECTN_WIDE_BOARDS
+template class ConnectNEval<ConnectFour8x9Board>;
+template class ConnectNEval<ConnectFive8x9Board>;
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+#include "ConnectFourBoard.h"
+#include <cstdint>
+
+// Heuristic Connect-N evaluation, from the AI's (Yellow, second player) point of view:
+// every window of WIN cells scores by its stone counts, held center stones score, and so do
+// threats on the rows where they tend to decide the endgame (odd rows for Red, even rows
+// for Yellow, counting from the bottom).
+//
+// scan() evaluates a position from scratch. The incremental form keeps each window's stone
+// counts and the window/center total up to date as stones are added and removed during search,
+// so a leaf costs one table read plus the threat masks.
+template <class Board>
+class ConnectNEval {
+public:
+    using Bits = typename Board::Bits;
+    static constexpr int ROWS = Board::ROWS;
+    static constexpr int COLS = Board::COLS;
+    static constexpr int WIN = Board::WIN;
+    static constexpr int CELLS = Board::H1 * COLS; // bitboard indices, sentinels included
+    static constexpr int WINDOWS = ROWS * (COLS - WIN + 1) + COLS * (ROWS - WIN + 1) + 2 * (ROWS - WIN + 1) * (COLS - WIN + 1);
+    static_assert(WINDOWS <= 256, "window indices are bytes");
+    static constexpr int CENTER_WEIGHT = 6;
+    static constexpr int THREAT_WEIGHT = 40;
+
+    static constexpr int scoreCount(int countSelf, int countOpp, int countEmpty) {
+        if (countSelf == WIN) return 100000;
+        if (countSelf == WIN - 1 && countEmpty == 1) return 100;
+        if (countSelf == WIN - 2 && countEmpty == 2) return 10;
+        if (countOpp == WIN - 1 && countEmpty == 1) return -120; // prioritize blocking
+        if (countOpp == WIN - 2 && countEmpty == 2) return -8;
+        return 0;
+    }
+    static constexpr int windowScore(int countY, int countR) {
+        int countE = WIN - countY - countR;
+        return scoreCount(countY, countR, countE) - scoreCount(countR, countY, countE) / 10; // small asymmetry
+    }
+
+    // Threats by row parity: Red's on odd rows and Yellow's on even rows are the good ones
+    static constexpr Bits ODD_ROWS = [] {
+        Bits b = 0;
+        for (int row = 0; row < ROWS; row += 2) b |= connectn::rowMask<Bits>(Board::H1, COLS, row); // 1, 3, 5... from the bottom
+        return b;
+    }();
+    static int threatScore(const Board& pos);
+
+    static int scan(const Board& pos);
+
+    void reset(const Board& pos);
+    void add(Bits move, bool yellow);    // one stone, before play()
+    void remove(Bits move, bool yellow); // the same stone, after the search below it
+    int score(const Board& pos) const { return total + threatScore(pos); }
+
+private:
+    uint8_t count[2][WINDOWS]; // [0] = Red, [1] = Yellow
+    int total = 0;              // windows and center
+};
+
+using ConnectFourEval = ConnectNEval<ConnectFourBoard>;
@@ -0,0 +1,245 @@
+#include "ConnectFourLeaves.h"
+#include "ConnectFourEval.h"
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CONNECTFOUR_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define LEAVES_INLINE __forceinline
+#define LEAVES_AVX2
+#else
+#define LEAVES_INLINE inline __attribute__((always_inline))
+// Only the AVX2 lane functions and kernel are built for AVX2, so the binary runs anywhere. The
+// shared kernel templates hold __m256i values but are always inlined into AVX2 code, so GCC's
+// note about the AVX calling convention does not apply.
+#define LEAVES_AVX2 __attribute__((target("avx2")))
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+#else
+#define CONNECTFOUR_SIMD 0
+#define LEAVES_INLINE inline
+#endif
+
+namespace {
+    using Board = ConnectFourBoard;
+    using Eval = ConnectFourEval;
+
+    constexpr uint64_t CENTER = Board::columnMask(Board::COLS / 2);
+    constexpr uint64_t ODD_ROWS = Eval::ODD_ROWS;
+
+    // Lane types: bitwise ops, shifts, per-byte popcounts, byte sums per 64-bit lane, and a
+    // multiply-accumulate of small counts by signed weights (modulo 2^32, read back as int32)
+    struct ScalarLanes {
+        using V = uint64_t;
+        static constexpr int N = 1;
+        static V load(const uint64_t* p) { return *p; }
+        static void store(uint64_t* p, V v) { *p = v; }
+        static V set(uint64_t x) { return x; }
+        static V andV(V a, V b) { return a & b; }
+        static V orV(V a, V b) { return a | b; }
+        static V xorV(V a, V b) { return a ^ b; }
+        static V andNot(V a, V b) { return ~a & b; }
+        static V shl(V a, int n) { return a << n; }
+        static V shr(V a, int n) { return a >> n; }
+        static V bytePop(V x) {
+            x = x - ((x >> 1) & 0x5555555555555555ULL);
+            x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+            return (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        }
+        static V addBytes(V a, V b) { return a + b; }
+        static V sumBytes(V x) { return (x * 0x0101010101010101ULL) >> 56; }
+        static V mulAdd(V acc, V count, int weight) { return acc + count * (uint32_t)weight; }
+    };
+
+#if CONNECTFOUR_SIMD
+    struct Sse2Lanes {
+        using V = __m128i;
+        static constexpr int N = 2;
+        static V load(const uint64_t* p) { return _mm_loadu_si128((const __m128i*)p); }
+        static void store(uint64_t* p, V v) { _mm_storeu_si128((__m128i*)p, v); }
+        static V set(uint64_t x) { return _mm_set1_epi64x((long long)x); }
+        static V andV(V a, V b) { return _mm_and_si128(a, b); }
+        static V orV(V a, V b) { return _mm_or_si128(a, b); }
+        static V xorV(V a, V b) { return _mm_xor_si128(a, b); }
+        static V andNot(V a, V b) { return _mm_andnot_si128(a, b); }
+        static V shl(V a, int n) { return _mm_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+        static V shr(V a, int n) { return _mm_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+        static V bytePop(V x) {
+            const V m1 = _mm_set1_epi8(0x55), m2 = _mm_set1_epi8(0x33), m4 = _mm_set1_epi8(0x0F);
+            x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi64(x, 1), m1));
+            x = _mm_add_epi8(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi64(x, 2), m2));
+            return _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi64(x, 4)), m4);
+        }
+        static V addBytes(V a, V b) { return _mm_add_epi8(a, b); }
+        static V sumBytes(V x) { return _mm_sad_epu8(x, _mm_setzero_si128()); }
+        static V mulAdd(V acc, V count, int weight) { return _mm_add_epi64(acc, _mm_mul_epu32(count, _mm_set1_epi32(weight))); }
+    };
+
+    struct Avx2Lanes {
+        using V = __m256i;
+        static constexpr int N = 4;
+        LEAVES_AVX2 static V load(const uint64_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+        LEAVES_AVX2 static void store(uint64_t* p, V v) { _mm256_storeu_si256((__m256i*)p, v); }
+        LEAVES_AVX2 static V set(uint64_t x) { return _mm256_set1_epi64x((long long)x); }
+        LEAVES_AVX2 static V andV(V a, V b) { return _mm256_and_si256(a, b); }
+        LEAVES_AVX2 static V orV(V a, V b) { return _mm256_or_si256(a, b); }
+        LEAVES_AVX2 static V xorV(V a, V b) { return _mm256_xor_si256(a, b); }
+        LEAVES_AVX2 static V andNot(V a, V b) { return _mm256_andnot_si256(a, b); }
+        LEAVES_AVX2 static V shl(V a, int n) { return _mm256_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+        LEAVES_AVX2 static V shr(V a, int n) { return _mm256_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+        // Nibble lookup instead of the bit-twiddling SWAR count
+        LEAVES_AVX2 static V bytePop(V x) {
+            const V table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const V low = _mm256_set1_epi8(0x0F);
+            return _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(x, low)),
+                _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi64(x, 4), low)));
+        }
+        LEAVES_AVX2 static V addBytes(V a, V b) { return _mm256_add_epi8(a, b); }
+        LEAVES_AVX2 static V sumBytes(V x) { return _mm256_sad_epu8(x, _mm256_setzero_si256()); }
+        LEAVES_AVX2 static V mulAdd(V acc, V count, int weight) { return _mm256_add_epi64(acc, _mm256_mul_epu32(count, _mm256_set1_epi32(weight))); }
+    };
+#endif
+
+    // Empty cells that would complete a four for `s` (Board::winningCells, lane-wise)
+    template <class L>
+    LEAVES_INLINE void winningCells(const typename L::V& s, const typename L::V& occupied, typename L::V& cells) {
+        using V = typename L::V;
+        V r = L::andV(L::andV(L::shl(s, 1), L::shl(s, 2)), L::shl(s, 3));
+        for (int d : { Board::H1, Board::H1 - 1, Board::H1 + 1 }) {
+            V l1 = L::shl(s, d), l2 = L::shl(s, 2 * d), r1 = L::shr(s, d), r2 = L::shr(s, 2 * d);
+            V inner = L::andV(l1, r1);
+            r = L::orV(r, L::andV(L::andV(r1, r2), L::shr(s, 3 * d)));
+            r = L::orV(r, L::andV(inner, r2));
+            r = L::orV(r, L::andV(inner, l2));
+            r = L::orV(r, L::andV(L::andV(l1, l2), L::shl(s, 3 * d)));
+        }
+        cells = L::andNot(occupied, L::andV(r, L::set(Board::FULL)));
+    }
+
+    // Per-byte counts of own's windows free of `other` along `shift`, by stones held (2, 3), added
+    // into the accumulators (Board::lines, lane-wise). Fours are left out: a child that completes
+    // one is flagged as won, and in any other neither side has one.
+    template <class L>
+    LEAVES_INLINE void addLines(const typename L::V& own, const typename L::V& other, int shift, typename L::V* held) {
+        using V = typename L::V;
+        V open = L::andNot(other, L::set(Board::FULL));
+        V windows = L::andV(L::andV(open, L::shr(open, shift)), L::andV(L::shr(open, 2 * shift), L::shr(open, 3 * shift)));
+        V a = own, b = L::shr(own, shift), c = L::shr(own, 2 * shift), d = L::shr(own, 3 * shift);
+        V s1 = L::xorV(a, b), c1 = L::andV(a, b), s2 = L::xorV(c, d), c2 = L::andV(c, d);
+        V carry = L::andV(s1, s2);
+        V bit0 = L::xorV(s1, s2);
+        V bit1 = L::xorV(L::xorV(c1, c2), carry);
+        V two = L::andNot(bit0, L::andV(windows, bit1)); // 3 is the only count with bits 0 and 1 set
+        V three = L::andV(L::andV(windows, bit0), bit1);
+        held[0] = L::addBytes(held[0], L::bytePop(two));
+        held[1] = L::addBytes(held[1], L::bytePop(three));
+    }
+
+    template <class L>
+    LEAVES_INLINE void kernel(const Board& pos, const uint64_t* moves, int n, int* scores, bool* won) {
+        using V = typename L::V;
+        static constexpr int WY[2] = { Eval::windowScore(2, 0), Eval::windowScore(3, 0) };
+        static constexpr int WR[2] = { Eval::windowScore(0, 2), Eval::windowScore(0, 3) };
+        bool yellowToMove = pos.moves & 1;
+        for (int base = 0; base < n; base += L::N) {
+            uint64_t lane[L::N];
+            for (int i = 0; i < L::N; ++i) lane[i] = base + i < n ? moves[base + i] : 0;
+            V move = L::load(lane);
+            V red = L::set(pos.firstPlayer()), yellow = L::set(pos.secondPlayer());
+            if (yellowToMove) yellow = L::orV(yellow, move);
+            else red = L::orV(red, move);
+            V occupied = L::orV(L::set(pos.mask), move);
+
+            // Win test for the side that moved (Board::alignment)
+            V own = yellowToMove ? yellow : red;
+            V line = L::set(0);
+            for (int d : { 1, Board::H1, Board::H1 - 1, Board::H1 + 1 }) {
+                V pairs = L::andV(own, L::shr(own, d));
+                line = L::orV(line, L::andV(pairs, L::shr(pairs, 2 * d)));
+            }
+
+            // Windows, center stones and threats (ConnectFourEval::scan)
+            V heldY[2] = { L::set(0), L::set(0) }, heldR[2] = { L::set(0), L::set(0) };
+            for (int d : { 1, Board::H1, Board::H1 - 1, Board::H1 + 1 }) {
+                addLines<L>(yellow, red, d, heldY);
+                addLines<L>(red, yellow, d, heldR);
+            }
+            V score = L::set(0);
+            for (int k = 0; k < 2; ++k) {
+                score = L::mulAdd(score, L::sumBytes(heldY[k]), WY[k]);
+                score = L::mulAdd(score, L::sumBytes(heldR[k]), WR[k]);
+            }
+            V center = L::set(CENTER);
+            score = L::mulAdd(score, L::sumBytes(L::bytePop(L::andV(yellow, center))), Eval::CENTER_WEIGHT);
+            score = L::mulAdd(score, L::sumBytes(L::bytePop(L::andV(red, center))), -Eval::CENTER_WEIGHT);
+            V threatsY, threatsR;
+            winningCells<L>(yellow, occupied, threatsY);
+            winningCells<L>(red, occupied, threatsR);
+            threatsY = L::andNot(L::set(ODD_ROWS), threatsY);
+            threatsR = L::andV(L::set(ODD_ROWS), threatsR);
+            score = L::mulAdd(score, L::sumBytes(L::bytePop(threatsY)), Eval::THREAT_WEIGHT);
+            score = L::mulAdd(score, L::sumBytes(L::bytePop(threatsR)), -Eval::THREAT_WEIGHT);
+
+            uint64_t scoreLanes[L::N], lineLanes[L::N];
+            L::store(scoreLanes, score);
+            L::store(lineLanes, line);
+            for (int i = 0; i < L::N && base + i < n; ++i) {
+                scores[base + i] = (int32_t)(uint32_t)scoreLanes[i];
+                won[base + i] = lineLanes[i] != 0;
+            }
+        }
+    }
+
+    void scalarKernel(const Board& pos, const uint64_t* moves, int n, int* scores, bool* won) {
+        kernel<ScalarLanes>(pos, moves, n, scores, won);
+    }
+#if CONNECTFOUR_SIMD
+    void sse2Kernel(const Board& pos, const uint64_t* moves, int n, int* scores, bool* won) {
+        kernel<Sse2Lanes>(pos, moves, n, scores, won);
+    }
+    LEAVES_AVX2 void avx2Kernel(const Board& pos, const uint64_t* moves, int n, int* scores, bool* won) {
+        kernel<Avx2Lanes>(pos, moves, n, scores, won);
+    }
+
+    bool cpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5));
+#else
+        return __builtin_cpu_supports("avx2"); // also checks the OS saves the YMM registers
+#endif
+    }
+#endif
+}
+
+bool ConnectFourLeaves::supported(Kernel k) {
+#if CONNECTFOUR_SIMD
+    static const bool avx2 = cpuHasAvx2();
+    return k != Kernel::AVX2 || avx2;
+#else
+    return k == Kernel::SCALAR;
+#endif
+}
+
+// SSE2's two lanes lose to the incremental evaluation (--bench c4leaves), so it is never the default
+ConnectFourLeaves::Kernel ConnectFourLeaves::best() {
+    static const Kernel k = supported(Kernel::AVX2) ? Kernel::AVX2 : Kernel::SCALAR;
+    return k;
+}
+
+const char* ConnectFourLeaves::name(Kernel k) {
+    return k == Kernel::AVX2 ? "avx2" : k == Kernel::SSE2 ? "sse2" : "scalar";
+}
+
+void ConnectFourLeaves::evaluate(Kernel k, const ConnectFourBoard& pos, const uint64_t* moves, int n, int* scores, bool* won) {
+#if CONNECTFOUR_SIMD
+    if (k == Kernel::AVX2) { avx2Kernel(pos, moves, n, scores, won); return; }
+    if (k == Kernel::SSE2) { sse2Kernel(pos, moves, n, scores, won); return; }
+#endif
+    scalarKernel(pos, moves, n, scores, won);
+}
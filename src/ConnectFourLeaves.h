@@ -0,0 +1,24 @@
+#pragma once
+#include "ConnectFourBoard.h"
+#include <cstdint>
+
+// Leaf scores for all children of one position at once, for the last ply of the alpha-beta
+// search: each child's bitboards go into a SIMD lane, and the win test, window counts and
+// threat masks run over every lane together. A child that completes a line is flagged; any
+// other scores exactly ConnectFourEval::scan().
+//
+// Kernels: AVX2 (4 children per pass), SSE2 (2) and a scalar one. best() is AVX2 when the CPU
+// has it, checked once, and otherwise SCALAR, for which the search keeps its incremental
+// evaluation; off x86-64 only the scalar kernel exists.
+class ConnectFourLeaves {
+public:
+    enum class Kernel { SCALAR, SSE2, AVX2 };
+
+    static Kernel best();
+    static bool supported(Kernel k);
+    static const char* name(Kernel k);
+    static int lanes(Kernel k) { return k == Kernel::AVX2 ? 4 : k == Kernel::SSE2 ? 2 : 1; } // children per pass
+
+    // `moves` are n <= COLS cells of pos.playable()
+    static void evaluate(Kernel k, const ConnectFourBoard& pos, const uint64_t* moves, int n, int* scores, bool* won);
+};
@@ -0,0 +1,290 @@
+#include "ConnectFourMCTS.h"
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+    // xorshift64*, one state per thread
+    inline uint64_t nextRandom(uint64_t& s) {
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        return s * 0x2545F4914F6CDD1DULL;
+    }
+
+    // One of the set bits of `moves`, uniformly
+    inline uint64_t randomBit(uint64_t moves, uint64_t& rng) {
+        int n = ConnectFourBoard::popCount(moves);
+        int k = (int)(((nextRandom(rng) >> 32) * (uint64_t)n) >> 32);
+        while (k--) moves &= moves - 1;
+        return moves & (0 - moves);
+    }
+}
+
+ConnectFourMCTS::ConnectFourMCTS(uint32_t nodeCapacity) {
+    capacity = nodeCapacity < 64 ? 64 : nodeCapacity;
+    arena.reset(new Node[capacity]);
+}
+
+void ConnectFourMCTS::clear() {
+    hasTree = false;
+    used = 0;
+}
+
+uint32_t ConnectFourMCTS::allocate(uint32_t count) {
+    // Checked first so a full arena stops the counter, not just the allocation
+    if (used.load(std::memory_order_relaxed) + count > capacity) return NO_NODE;
+    uint32_t first = used.fetch_add(count, std::memory_order_relaxed);
+    if (first + count > capacity) return NO_NODE;
+    return first;
+}
+
+// Children for the moves worth playing: the win if there is one, else the moves that do not
+// hand the opponent a win (all of them when every move does)
+void ConnectFourMCTS::expand(uint32_t index, const Board& pos) {
+    Node& node = arena[index];
+    uint8_t expected = LEAF;
+    if (!node.state.compare_exchange_strong(expected, EXPANDING, std::memory_order_acq_rel)) return;
+
+    Bits wins = pos.threats() & pos.playable();
+    Bits candidates = wins ? (wins & (0 - wins)) : pos.nonLosingMoves();
+    if (!candidates) candidates = pos.playable();
+    int columns[Board::COLS], n = 0;
+    float weights[Board::COLS], total = 0.0f;
+    for (int col : Board::CENTER_ORDER) {
+        Bits move = candidates & Board::columnMask(col);
+        if (!move) continue;
+        columns[n] = col;
+        weights[n] = (float)(1 + Board::COLS / 2 - std::abs(col - Board::COLS / 2) + 2 * pos.threatCount(move));
+        total += weights[n++];
+    }
+    uint32_t first = allocate((uint32_t)n);
+    if (first == NO_NODE) return; // stays EXPANDING: a leaf for good, its visits end in playouts
+
+    for (int i = 0; i < n; ++i) {
+        Node& child = arena[first + i];
+        child.visits.store(0, std::memory_order_relaxed);
+        child.score.store(0, std::memory_order_relaxed);
+        child.state.store(LEAF, std::memory_order_relaxed);
+        child.column = (int8_t)columns[i];
+        child.outcome = pos.isWinningMove(columns[i]) ? WIN : (pos.moves + 1 == Board::CELLS) ? DRAW : NONE;
+        child.childCount = 0;
+        child.prior = weights[i] / total;
+        child.firstChild = 0;
+    }
+    node.firstChild = first;
+    node.childCount = (uint8_t)n;
+    node.state.store(EXPANDED, std::memory_order_release);
+}
+
+uint32_t ConnectFourMCTS::select(const Node& node) const {
+    uint32_t parentVisits = node.visits.load(std::memory_order_relaxed);
+    double logN = std::log((double)(parentVisits ? parentVisits : 1));
+    double sqrtN = std::sqrt((double)parentVisits);
+    uint32_t best = node.firstChild;
+    double bestValue = -1.0;
+    for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; ++i) {
+        const Node& child = arena[i];
+        uint32_t n = child.visits.load(std::memory_order_relaxed);
+        double mean = n ? child.score.load(std::memory_order_relaxed) / (2.0 * n) : 0.5;
+        double value;
+        if (policy == MCTSPolicy::UCT) {
+            if (n == 0) return i; // center-out, like the children
+            value = mean + exploration * std::sqrt(logN / n);
+        }
+        else {
+            value = mean + exploration * child.prior * sqrtN / (1.0 + n);
+        }
+        if (value > bestValue) { bestValue = value; best = i; }
+    }
+    return best;
+}
+
+int ConnectFourMCTS::rollout(Board pos, uint64_t& rng) {
+    bool moverToPlay = false; // whether the side that moved into the starting position is to move
+    for (;;) {
+        if (pos.canWinNext()) return moverToPlay ? 2 : 0;
+        Bits moves = pos.nonLosingMoves();
+        if (!moves) return moverToPlay ? 0 : 2; // every move lets the other side win
+        pos.play(randomBit(moves, rng));
+        moverToPlay = !moverToPlay;
+        if (pos.full()) return 1;
+    }
+}
+
+void ConnectFourMCTS::playout(uint64_t& rng) {
+    Board pos = rootPos;
+    uint32_t path[Board::CELLS + 1];
+    int depth = 0;
+    uint32_t index = 0;
+    path[depth++] = 0;
+    arena[0].visits.fetch_add(1, std::memory_order_relaxed);
+
+    // Down: each visit counts at once, the virtual loss the other threads steer around
+    int result;
+    for (;;) {
+        Node& node = arena[index];
+        if (node.outcome != NONE) { result = node.outcome == WIN ? 2 : 1; break; }
+        uint8_t state = node.state.load(std::memory_order_acquire);
+        if (state == LEAF && node.visits.load(std::memory_order_relaxed) > EXPAND_AFTER) {
+            expand(index, pos);
+            state = node.state.load(std::memory_order_acquire);
+        }
+        if (state != EXPANDED) { result = rollout(pos, rng); break; }
+        index = select(node);
+        arena[index].visits.fetch_add(1, std::memory_order_relaxed);
+        pos.play(arena[index].column);
+        path[depth++] = index;
+    }
+
+    // Up: the result for the side that moved into each node, alternating
+    for (int i = depth - 1; i >= 0; --i) {
+        arena[path[i]].score.fetch_add((uint32_t)result, std::memory_order_relaxed);
+        result = 2 - result;
+    }
+}
+
+void ConnectFourMCTS::run(int index) {
+    if (index > 0) CpuTopology::placeWorker(index, threads, placement);
+    uint64_t rng = seed ^ (rootPos.key() * 0xBF58476D1CE4E5B9ULL) ^ ((uint64_t)(index + 1) * 0x94D049BB133111EBULL);
+    if (!rng) rng = 1;
+    // Playouts are counted in batches, and the clock read every 32 (a few microseconds)
+    const uint64_t batch = 16;
+    uint64_t pending = 0;
+    for (uint64_t local = 1; !done.load(std::memory_order_relaxed); ++local) {
+        playout(rng);
+        if (++pending == batch) {
+            uint64_t total = playouts.fetch_add(pending, std::memory_order_relaxed) + pending;
+            pending = 0;
+            if (playoutLimit && total >= playoutLimit) done = true;
+        }
+        if (timeLimit > 0.0 && (local & 31) == 0 && std::chrono::steady_clock::now() >= deadline) done = true;
+    }
+    playouts.fetch_add(pending, std::memory_order_relaxed);
+}
+
+// The node under `index` (reached at `at`) for `target`, at most `plies` moves down the tree
+uint32_t ConnectFourMCTS::find(uint32_t index, const Board& at, const Board& target, int plies) const {
+    if (at.mask == target.mask && at.current == target.current) return index;
+    const Node& node = arena[index];
+    if (plies <= 0 || node.state.load(std::memory_order_acquire) != EXPANDED) return NO_NODE;
+    // Stones of the side to move at `at`, as they stand in the target
+    Bits mine = ((target.moves - at.moves) & 1) ? target.opponent() : target.current;
+    for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; ++i) {
+        Bits move = at.dropCell(arena[i].column);
+        if (!(move & mine)) continue;
+        Board next = at;
+        next.play(move);
+        uint32_t found = find(i, next, target, plies - 1);
+        if (found != NO_NODE) return found;
+    }
+    return NO_NODE;
+}
+
+// Moves the subtree under `index` to the front of the arena, breadth first: each node's
+// children are still side by side, and everything else is freed
+uint32_t ConnectFourMCTS::reroot(uint32_t index) {
+    struct Saved {
+        uint32_t visits, score, firstChild;
+        uint8_t state, childCount, outcome;
+        int8_t column;
+        float prior;
+    };
+    std::vector<Saved> kept;
+    std::vector<uint32_t> order{ index };
+    for (size_t i = 0; i < order.size(); ++i) {
+        const Node& node = arena[order[i]];
+        Saved s{ node.visits.load(), node.score.load(), 0, node.state.load(), 0, node.outcome, node.column, node.prior };
+        if (s.state == EXPANDED) {
+            s.firstChild = (uint32_t)order.size();
+            s.childCount = node.childCount;
+            for (uint32_t c = 0; c < node.childCount; ++c) order.push_back(node.firstChild + c);
+        }
+        else {
+            s.state = LEAF; // out of arena before, may grow now
+        }
+        kept.push_back(s);
+    }
+    for (size_t i = 0; i < kept.size(); ++i) {
+        Node& node = arena[i];
+        const Saved& s = kept[i];
+        node.visits.store(s.visits, std::memory_order_relaxed);
+        node.score.store(s.score, std::memory_order_relaxed);
+        node.state.store(s.state, std::memory_order_relaxed);
+        node.column = s.column;
+        node.outcome = s.outcome;
+        node.childCount = s.childCount;
+        node.prior = s.prior;
+        node.firstChild = s.firstChild;
+    }
+    used = (uint32_t)kept.size();
+    return (uint32_t)kept.size();
+}
+
+ConnectFourMCTSResult ConnectFourMCTS::search(const Board& pos) {
+    ConnectFourMCTSResult result;
+    for (int col : Board::CENTER_ORDER) {
+        if (pos.canPlay(col) && pos.isWinningMove(col)) {
+            result.column = col;
+            result.value = 1.0;
+            return result;
+        }
+    }
+    Bits safe = pos.nonLosingMoves();
+    if (safe && !(safe & (safe - 1))) {
+        result.column = Board::lowestBit(safe) / Board::H1;
+        return result;
+    }
+
+    // Keep the subtree of the position reached since the last search, if the tree has it
+    uint32_t root = NO_NODE;
+    int plies = pos.moves - rootPos.moves;
+    if (hasTree && plies >= 0 && plies <= REUSE_PLIES) root = find(0, rootPos, pos, plies);
+    if (root == 0) result.reused = used;
+    else if (root != NO_NODE) result.reused = reroot(root);
+    // A fresh tree also when the kept one left no room for the root's children
+    if (root != NO_NODE && arena[0].state.load() != EXPANDED && used + Board::COLS > capacity) root = NO_NODE;
+    if (root == NO_NODE) {
+        result.reused = 0;
+        used = 1;
+        Node& node = arena[0];
+        node.visits = 0;
+        node.score = 0;
+        node.state = LEAF;
+        node.column = -1;
+        node.outcome = NONE;
+        node.childCount = 0;
+        node.prior = 1.0f;
+        node.firstChild = 0;
+    }
+    rootPos = pos;
+    hasTree = true;
+    expand(0, pos);
+
+    playouts = 0;
+    done = false;
+    if (timeLimit > 0.0) {
+        deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeLimit));
+    }
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(&ConnectFourMCTS::run, this, t);
+    run(0);
+    for (auto& t : pool) t.join();
+
+    // The most visited move
+    const Node& node = arena[0];
+    uint32_t bestVisits = 0;
+    for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; ++i) {
+        uint32_t n = arena[i].visits.load(std::memory_order_relaxed);
+        if (result.column < 0 || n > bestVisits) {
+            bestVisits = n;
+            result.column = arena[i].column;
+            result.value = n ? arena[i].score.load(std::memory_order_relaxed) / (2.0 * n) : 0.5;
+        }
+    }
+    result.playouts = playouts;
+    uint32_t size = used.load(std::memory_order_relaxed);
+    result.nodes = size < capacity ? size : capacity;
+    return result;
+}
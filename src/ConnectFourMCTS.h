@@ -0,0 +1,103 @@
+#pragma once
+#include "ConnectFourBoard.h"
+#include "CpuTopology.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+enum class MCTSPolicy {
+    UCT,  // mean score plus c * sqrt(ln N / n)
+    PUCT, // mean score plus c * prior * sqrt(N) / (1 + n), priors from center and threats
+};
+
+struct ConnectFourMCTSResult {
+    int column = -1;
+    double value = 0.5;    // expected score of `column` for the side to move: 1 win, 0.5 draw, 0 loss
+    uint64_t playouts = 0; // this search
+    uint32_t nodes = 0;    // in the tree afterwards
+    uint32_t reused = 0;   // kept from the previous search
+};
+
+// Monte Carlo tree search for Connect Four, as an alternative to the alpha-beta AI. Playouts
+// run on the bitboard: a side that can win takes the win, and otherwise plays a random move that
+// does not hand the opponent one (Board::nonLosingMoves), which settles most games in a few
+// masks. Nodes are expanded after a few playouts, with the same filter applied to their moves.
+//
+// Nodes live in one preallocated arena, each node's children side by side, so the tree costs
+// no allocation while it grows; once the arena is full the tree stops growing and playouts
+// continue from its leaves. With more than one thread every thread walks the shared tree: a
+// visit is counted on the way down and its result added on the way up, so until then the path
+// looks like a loss (a virtual loss) and the other threads spread out.
+//
+// Between searches the tree is kept. When the next search starts from a position a few moves
+// further down (the AI's move and the reply), that subtree is compacted to the front of the
+// arena and becomes the new root; anything else starts a fresh tree.
+class ConnectFourMCTS {
+public:
+    using Board = ConnectFourBoard;
+    using Bits = Board::Bits;
+    static constexpr int EXPAND_AFTER = 4; // visits before a leaf gets children
+    static constexpr int REUSE_PLIES = 4;  // furthest the next root is looked for
+
+    explicit ConnectFourMCTS(uint32_t nodeCapacity = 1u << 20);
+    ConnectFourMCTS(const ConnectFourMCTS&) = delete;
+    ConnectFourMCTS& operator=(const ConnectFourMCTS&) = delete;
+
+    // Threads per search, the calling thread included; 1 (the default) searches serially
+    void setThreads(int count, const ThreadPlacement& where = ThreadPlacement{}) { threads = count < 1 ? 1 : count; placement = where; }
+    // Budget per search; a search stops at whichever limit it reaches first (0 = none, but
+    // one of them must be set)
+    void setTimeLimit(double seconds) { timeLimit = seconds; }
+    void setPlayoutLimit(uint64_t playouts) { playoutLimit = playouts; }
+    // Also resets the exploration constant to the policy's default
+    void setPolicy(MCTSPolicy p) { policy = p; exploration = (p == MCTSPolicy::UCT) ? 1.0 : 2.0; }
+    void setExploration(double c) { exploration = c; }
+    void setSeed(uint64_t s) { seed = s; }
+    void clear(); // drop the kept tree
+
+    // Position must not be finished. Immediate wins and single forced moves return without a search.
+    ConnectFourMCTSResult search(const Board& pos);
+
+private:
+    struct Node {
+        std::atomic<uint32_t> visits{ 0 }; // virtual losses included
+        std::atomic<uint32_t> score{ 0 };  // 2 per win, 1 per draw, for the side that moved into the node
+        std::atomic<uint8_t> state{ 0 };   // LEAF, EXPANDING (or out of arena), EXPANDED
+        int8_t column = -1;
+        uint8_t outcome = 0;               // NONE, WIN (for the mover) or DRAW after this move
+        uint8_t childCount = 0;
+        float prior = 0.0f;
+        uint32_t firstChild = 0;
+    };
+    enum : uint8_t { LEAF, EXPANDING, EXPANDED };
+    enum : uint8_t { NONE, WIN, DRAW };
+    static constexpr uint32_t NO_NODE = 0xFFFFFFFFu;
+
+    uint32_t allocate(uint32_t count); // NO_NODE when the arena is full
+    void expand(uint32_t index, const Board& pos);
+    uint32_t select(const Node& node) const;
+    static int rollout(Board pos, uint64_t& rng); // score for the side that moved into pos
+    void playout(uint64_t& rng);
+    void run(int index);
+    uint32_t find(uint32_t index, const Board& at, const Board& target, int plies) const;
+    uint32_t reroot(uint32_t index); // nodes kept
+
+    std::unique_ptr<Node[]> arena;
+    uint32_t capacity = 0;
+    std::atomic<uint32_t> used{ 0 };
+    Board rootPos;
+    bool hasTree = false;
+
+    int threads = 1;
+    ThreadPlacement placement;
+    double timeLimit = 1.0;
+    uint64_t playoutLimit = 0;
+    MCTSPolicy policy = MCTSPolicy::UCT;
+    double exploration = 1.0;
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic<uint64_t> playouts{ 0 };
+    std::atomic<bool> done{ false };
+};
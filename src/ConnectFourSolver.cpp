@@ -0,0 +1,338 @@
+#include "ConnectFourSolver.h"
+#include <algorithm>
+#include <deque>
+
+template <class Board>
+struct ConnectNSolver<Board>::SplitPoint {
+    const SplitPoint* parent = nullptr;
+    int alpha = 0, beta = 0;
+    std::atomic<int> pending{ 0 };
+    std::atomic<bool> cutoff{ false };
+    int score = 0, column = -1; // written once, by the brother that cut off
+};
+
+template <class Board>
+struct ConnectNSolver<Board>::Task {
+    SplitPoint* split = nullptr;
+    Board child;
+    int column = -1;
+};
+
+template <class Board>
+struct alignas(64) ConnectNSolver<Board>::Worker {
+    std::mutex lock;
+    std::deque<Task> tasks; // owner pushes and pops at the back, thieves take from the front
+    uint64_t nodes = 0;
+};
+
+template <class Board>
+ConnectNSolver<Board>::ConnectNSolver(size_t tableKilobytes) : table(tableKilobytes) {
+    workers.push_back(std::make_unique<Worker>());
+}
+
+template <class Board>
+ConnectNSolver<Board>::~ConnectNSolver() {
+    stopPool();
+}
+
+template <class Board>
+void ConnectNSolver<Board>::setThreads(int threads, const ThreadPlacement& where) {
+    stopPool();
+    threads = std::max(1, threads);
+    placement = where;
+    while ((int)workers.size() < threads) workers.push_back(std::make_unique<Worker>());
+    workers.resize(threads);
+    quit = false;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(&ConnectNSolver::poolLoop, this, t);
+}
+
+template <class Board>
+void ConnectNSolver<Board>::stopPool() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (auto& t : pool) t.join();
+    pool.clear();
+}
+
+template <class Board>
+uint64_t ConnectNSolver<Board>::nodeCount() const {
+    uint64_t total = 0;
+    for (const auto& w : workers) total += w->nodes;
+    return total;
+}
+
+template <class Board>
+void ConnectNSolver<Board>::resetNodeCount() {
+    for (auto& w : workers) w->nodes = 0;
+}
+
+// Pool threads sleep between searches and steal while one runs
+template <class Board>
+void ConnectNSolver<Board>::poolLoop(int index) {
+    CpuTopology::placeWorker(index, (int)workers.size(), placement);
+    Worker& w = *workers[index];
+    Task task;
+    std::unique_lock<std::mutex> lock(poolMutex);
+    for (;;) {
+        wake.wait(lock, [this] { return quit || searching.load(); });
+        if (quit) return;
+        lock.unlock();
+        while (searching.load(std::memory_order_acquire)) {
+            if (takeTask(w, task, nullptr)) runTask(w, task);
+            else std::this_thread::yield();
+        }
+        lock.lock();
+    }
+}
+
+template <class Board>
+void ConnectNSolver<Board>::startClock() {
+    aborted = false;
+    if (timeLimit > 0.0) {
+        deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeLimit));
+    }
+    table.newSearch();
+    if (!pool.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            searching = true;
+        }
+        wake.notify_all();
+    }
+}
+
+template <class Board>
+void ConnectNSolver<Board>::finishSearch() {
+    searching = false;
+}
+
+template <class Board>
+bool ConnectNSolver<Board>::outOfTime(const Worker& w) {
+    // Each worker reads the clock every 4096 of its nodes
+    if (timeLimit > 0.0 && (w.nodes & 4095) == 0 && std::chrono::steady_clock::now() >= deadline) aborted = true;
+    return aborted.load(std::memory_order_relaxed);
+}
+
+// Out of time, or some split point above has already cut off
+template <class Board>
+bool ConnectNSolver<Board>::stopped(const SplitPoint* split) const {
+    if (aborted.load(std::memory_order_relaxed)) return true;
+    for (; split; split = split->parent) if (split->cutoff.load(std::memory_order_relaxed)) return true;
+    return false;
+}
+
+// A task from the worker's own deque, else the oldest one from another's; with `within`, only
+// tasks below that split point, so a waiting owner never wanders into an unrelated subtree
+template <class Board>
+bool ConnectNSolver<Board>::takeTask(Worker& w, Task& task, const SplitPoint* within) {
+    auto below = [within](const Task& t) {
+        if (!within) return true;
+        for (const SplitPoint* s = t.split; s; s = s->parent) if (s == within) return true;
+        return false;
+    };
+    {
+        std::lock_guard<std::mutex> lock(w.lock);
+        if (!w.tasks.empty() && below(w.tasks.back())) {
+            task = w.tasks.back();
+            w.tasks.pop_back();
+            return true;
+        }
+    }
+    for (auto& other : workers) {
+        if (other.get() == &w) continue;
+        std::lock_guard<std::mutex> lock(other->lock);
+        if (!other->tasks.empty() && below(other->tasks.front())) {
+            task = other->tasks.front();
+            other->tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+template <class Board>
+void ConnectNSolver<Board>::runTask(Worker& w, Task& task) {
+    SplitPoint& split = *task.split;
+    if (!stopped(&split)) {
+        int score = -negamax(w, task.child, -split.beta, -split.alpha, &split);
+        bool first = false;
+        if (!stopped(&split) && score >= split.beta && split.cutoff.compare_exchange_strong(first, true)) {
+            split.score = score;
+            split.column = task.column;
+        }
+    }
+    split.pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+// The younger brothers of a null-window node, in parallel. Returns the cutoff score (and its
+// column), or alpha when every brother failed low.
+template <class Board>
+int ConnectNSolver<Board>::searchBrothers(Worker& w, const Board& pos, const Bits* moves, const int* columns, int n,
+    int alpha, int beta, const SplitPoint* parent, int& column) {
+    SplitPoint split;
+    split.parent = parent;
+    split.alpha = alpha;
+    split.beta = beta;
+    split.pending = n;
+    {
+        // Reversed, so the owner pops the best-ordered brother first
+        std::lock_guard<std::mutex> lock(w.lock);
+        for (int i = n - 1; i >= 0; --i) {
+            Task task;
+            task.split = &split;
+            task.child = pos;
+            task.child.play(moves[i]);
+            task.column = columns[i];
+            w.tasks.push_back(task);
+        }
+    }
+    Task task;
+    while (split.pending.load(std::memory_order_acquire) > 0) {
+        if (takeTask(w, task, &split)) runTask(w, task);
+        else std::this_thread::yield();
+    }
+    if (!split.cutoff.load(std::memory_order_relaxed)) return alpha;
+    column = split.column;
+    return split.score;
+}
+
+// Precondition: the side to move cannot win immediately
+template <class Board>
+int ConnectNSolver<Board>::negamax(Worker& w, const Board& pos, int alpha, int beta, const SplitPoint* split) {
+    ++w.nodes;
+    if (outOfTime(w) || stopped(split)) return alpha;
+
+    Bits next = pos.nonLosingMoves();
+    if (next == 0) return -(CELLS - pos.moves) / 2; // every move lets the opponent win
+    if (pos.moves >= CELLS - 2) return 0;           // neither side can still complete a line
+    int known;
+    if (probeBook(pos, known)) return known;
+
+    // Score window this position can still reach
+    int lower = -(CELLS - 2 - pos.moves) / 2;
+    int upper = (CELLS - 1 - pos.moves) / 2;
+    int ttColumn = -1;
+    typename ConnectNTT<Board>::Key key = ConnectNTT<Board>::keyOf(pos);
+    ConnectFourTTEntry e;
+    if (table.probe(key, e)) {
+        ttColumn = e.column;
+        if (e.bound == TTBound::UPPER) upper = std::min(upper, e.score);
+        else if (e.bound == TTBound::LOWER) lower = std::max(lower, e.score);
+    }
+    if (alpha < lower) { alpha = lower; if (alpha >= beta) return alpha; }
+    if (beta > upper) { beta = upper; if (alpha >= beta) return beta; }
+
+    // Table move first, then by the threats each move creates (stable, so center-out on ties)
+    Bits moves[Board::COLS];
+    int scores[Board::COLS], columns[Board::COLS], n = 0;
+    for (int col : Board::CENTER_ORDER) {
+        Bits move = next & Board::columnMask(col);
+        if (!move) continue;
+        int score = (col == ttColumn) ? 1000 : pos.threatCount(move);
+        int i = n++;
+        for (; i > 0 && scores[i - 1] < score; --i) { moves[i] = moves[i - 1]; scores[i] = scores[i - 1]; columns[i] = columns[i - 1]; }
+        moves[i] = move; scores[i] = score; columns[i] = col;
+    }
+
+    // Brothers only split under a null window, where alpha cannot move without a cutoff
+    bool parallel = workers.size() > 1 && beta == alpha + 1 && CELLS - pos.moves >= SPLIT_EMPTY;
+    int bestColumn = -1;
+    for (int i = 0; i < n; ++i) {
+        int score, column = columns[i];
+        if (i == 1 && parallel) {
+            score = searchBrothers(w, pos, moves + 1, columns + 1, n - 1, alpha, beta, split, column);
+            if (stopped(split)) return alpha;
+            if (score >= beta) {
+                table.store(key, CELLS - pos.moves, score, TTBound::LOWER, column);
+                return score;
+            }
+            break;
+        }
+        Board child = pos;
+        child.play(moves[i]);
+        score = -negamax(w, child, -beta, -alpha, split);
+        if (stopped(split)) return alpha;
+        if (score >= beta) {
+            table.store(key, CELLS - pos.moves, score, TTBound::LOWER, column);
+            return score;
+        }
+        if (score > alpha) { alpha = score; bestColumn = column; }
+    }
+    table.store(key, CELLS - pos.moves, alpha, TTBound::UPPER, bestColumn >= 0 ? bestColumn : ttColumn);
+    return alpha;
+}
+
+template <class Board>
+int ConnectNSolver<Board>::bisect(const Board& pos) {
+    if (pos.canWinNext()) return (CELLS + 1 - pos.moves) / 2;
+    int known;
+    if (probeBook(pos, known)) return known;
+    int lower = -(CELLS - pos.moves) / 2, upper = (CELLS + 1 - pos.moves) / 2;
+    while (lower < upper && !aborted) {
+        // Probe near zero first: most positions are decided by the sign
+        int med = lower + (upper - lower) / 2;
+        if (med <= 0 && lower / 2 < med) med = lower / 2;
+        else if (med >= 0 && upper / 2 > med) med = upper / 2;
+        int r = negamax(*workers[0], pos, med, med + 1, nullptr);
+        if (aborted) break;
+        if (r <= med) upper = r;
+        else lower = r;
+    }
+    return lower;
+}
+
+template <class Board>
+bool ConnectNSolver<Board>::solve(const Board& pos, int& score) {
+    startClock();
+    score = bisect(pos);
+    finishSearch();
+    return !aborted;
+}
+
+template <class Board>
+ConnectFourSolution ConnectNSolver<Board>::bestMove(const Board& pos) {
+    ConnectFourSolution result;
+    uint64_t start = nodeCount();
+    for (int col : Board::CENTER_ORDER) {
+        if (pos.canPlay(col) && pos.isWinningMove(col)) {
+            result.column = col;
+            result.score = (CELLS + 1 - pos.moves) / 2;
+            result.solved = true;
+            return result;
+        }
+    }
+
+    startClock();
+    int score = bisect(pos);
+    if (!aborted) {
+        // The first column (center-out) after which the opponent cannot score above -score
+        for (int col : Board::CENTER_ORDER) {
+            if (!pos.canPlay(col)) continue;
+            Board child = pos;
+            child.play(col);
+            int reply = child.full() ? 0
+                : child.canWinNext() ? (CELLS + 1 - child.moves) / 2
+                : negamax(*workers[0], child, -score, -score + 1, nullptr);
+            if (aborted) break;
+            if (-reply >= score) {
+                result.column = col;
+                break;
+            }
+        }
+        result.score = score;
+        result.solved = !aborted && result.column >= 0;
+    }
+    finishSearch();
+    result.nodes = nodeCount() - start;
+    return result;
+}
+
+template class ConnectNSolver<ConnectFourBoard>;
+template class ConnectNSolver<ConnectFour7x8Board>;
+#if CONNECTN_WIDE_BOARDS
+template class ConnectNSolver<ConnectFour8x9Board>;
+template class ConnectNSolver<ConnectFive8x9Board>;
+#endif
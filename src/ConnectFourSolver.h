@@ -0,0 +1,107 @@
+#pragma once
+#include "ConnectFourBoard.h"
+#include "ConnectFourBook.h"
+#include "ConnectFourTT.h"
+#include "CpuTopology.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+struct ConnectFourSolution {
+    int column = -1;
+    int score = 0;       // see ConnectFourSolver::solve
+    bool solved = false; // false when the budget ran out first
+    uint64_t nodes = 0;
+};
+
+// Exact Connect-N solver. Scores are from the side to move: 0 is a draw, a win with k of
+// the mover's stones still unplayed scores k (so sooner wins score higher), a loss -k. Search
+// is negamax with alpha-beta over moves that do not hand the opponent an immediate win,
+// ordered by how many threats they create, driven by null-window probes that bisect the
+// score range (an MTD-style iterative search). Both bounds go into the transposition table,
+// which is kept between calls.
+//
+// With more than one thread the null-window searches run Young Brothers Wait on a
+// work-stealing pool: at a node with enough empty cells the first move is searched alone, and
+// only if it does not cut off do its younger brothers become tasks on the worker's own deque.
+// Idle workers steal the oldest tasks from the other deques; the owner works through its own
+// subtree's tasks while it waits, and a cutoff in one brother cancels the rest. All workers
+// share the lock-free table.
+//
+// Built for ConnectFourBoard and the larger boards declared next to it (ConnectFourSolver.cpp
+// instantiates them); the opening book only applies to the standard board.
+template <class Board>
+class ConnectNSolver {
+public:
+    using Bits = typename Board::Bits;
+    static constexpr int CELLS = Board::CELLS;
+    static constexpr int MAX_SCORE = (CELLS + 1) / 2 - (Board::WIN - 1); // fastest possible win
+    static constexpr int SPLIT_EMPTY = 20; // smallest subtree (in empty cells) worth a split
+
+    explicit ConnectNSolver(size_t tableKilobytes = 8 * 1024);
+    ~ConnectNSolver();
+    ConnectNSolver(const ConnectNSolver&) = delete;
+    ConnectNSolver& operator=(const ConnectNSolver&) = delete;
+
+    // Workers per solve()/bestMove(), the calling thread included; 1 (the default) searches
+    // serially. Not to be called while a search is running.
+    void setThreads(int threads, const ThreadPlacement& placement = ThreadPlacement{});
+    int threadCount() const { return (int)workers.size(); }
+
+    // Budget per solve()/bestMove() call; 0 = unlimited
+    void setTimeLimit(double seconds) { timeLimit = seconds; }
+    // Exact scores for positions up to book->ply() stones; must outlive the solver
+    void setBook(const ConnectFourBook* openingBook) { book = openingBook; }
+
+    // Position must not be finished (no line completed, not full)
+    bool solve(const Board& pos, int& score);
+    // Best column by exact score; among equals the one nearest the center
+    ConnectFourSolution bestMove(const Board& pos);
+
+    uint64_t nodeCount() const;
+    void resetNodeCount();
+
+private:
+    struct Worker;
+    struct SplitPoint;
+    struct Task;
+
+    int negamax(Worker& w, const Board& pos, int alpha, int beta, const SplitPoint* split);
+    int searchBrothers(Worker& w, const Board& pos, const Bits* moves, const int* columns, int n,
+        int alpha, int beta, const SplitPoint* parent, int& column);
+    bool takeTask(Worker& w, Task& task, const SplitPoint* within);
+    void runTask(Worker& w, Task& task);
+    void poolLoop(int index);
+    void stopPool();
+    int bisect(const Board& pos);
+    bool probeBook(const Board& pos, int& score) const {
+        if constexpr (std::is_same_v<Board, ConnectFourBoard>) return book && book->probe(pos, score);
+        else return false;
+    }
+    void startClock(); // also wakes the pool
+    void finishSearch();
+    bool outOfTime(const Worker& w);
+    bool stopped(const SplitPoint* split) const;
+
+    ConnectNTT<Board> table;
+    const ConnectFourBook* book = nullptr;
+    double timeLimit = 0.0;
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic<bool> aborted{ false };
+
+    std::vector<std::unique_ptr<Worker>> workers; // [0] is whichever thread calls in
+    std::vector<std::thread> pool;
+    ThreadPlacement placement;
+    std::mutex poolMutex;
+    std::condition_variable wake;
+    std::atomic<bool> searching{ false };
+    bool quit = false;
+};
+
+using ConnectFourSolver = ConnectNSolver<ConnectFourBoard>;
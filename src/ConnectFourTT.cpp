@@ -0,0 +1,76 @@
+#include "ConnectFourTT.h"
+#include <algorithm>
+
+static bool isPrime(size_t n) {
+    if (n < 2) return false;
+    for (size_t d = 2; d * d <= n; ++d) if (n % d == 0) return false;
+    return true;
+}
+
+template <class Board>
+typename ConnectNTT<Board>::Key ConnectNTT<Board>::keyOf(const Board& pos) {
+    Bits key = pos.key(), flipped = Board::mirror(key);
+    return flipped < key ? Key{ flipped, true } : Key{ key, false };
+}
+
+template <class Board>
+ConnectNTT<Board>::ConnectNTT(size_t kilobytes) {
+    size_t wanted = kilobytes * 1024 / (sizeof(uint64_t) * WORDS);
+    slotCount = wanted < (1u << 17) ? (1u << 17) : wanted;
+    while (!isPrime(slotCount)) ++slotCount;
+    slots.reset(new std::atomic<uint64_t>[slotCount * WORDS]);
+    clear();
+}
+
+template <class Board>
+uint64_t ConnectNTT<Board>::fold(Bits key) {
+    if constexpr (Board::WIDE) return (uint64_t)key ^ ((uint64_t)(key >> 64) * 0x9E3779B97F4A7C15ULL);
+    else return key;
+}
+
+template <class Board>
+uint64_t ConnectNTT<Board>::pack(uint32_t check, int depth, int score, TTBound bound, int column, uint64_t generation) {
+    return (uint64_t)check | ((uint64_t)(uint16_t)(int16_t)score << 32) | ((uint64_t)(std::min(depth, 63)) << 48)
+        | ((uint64_t)bound << 54) | ((uint64_t)(column + 1) << 56) | (generation << 60);
+}
+
+template <class Board>
+bool ConnectNTT<Board>::probe(const Key& key, ConnectFourTTEntry& out) const {
+    const std::atomic<uint64_t>* slot = &slots[fold(key.key) % slotCount * WORDS];
+    uint64_t data = slot[0].load(std::memory_order_relaxed);
+    TTBound bound = (TTBound)((data >> 54) & 3);
+    if (bound == TTBound::NONE || (uint32_t)data != (uint32_t)key.key) return false;
+    if (WORDS == 2 && (slot[1].load(std::memory_order_relaxed) ^ data) != high(key.key)) return false;
+    out.score = (int16_t)(uint16_t)(data >> 32);
+    out.depth = (int)((data >> 48) & 63);
+    out.bound = bound;
+    out.column = (int)((data >> 56) & 15) - 1;
+    if (key.mirrored && out.column >= 0) out.column = Board::COLS - 1 - out.column;
+    return true;
+}
+
+template <class Board>
+void ConnectNTT<Board>::store(const Key& key, int depth, int score, TTBound bound, int column) {
+    std::atomic<uint64_t>* slot = &slots[fold(key.key) % slotCount * WORDS];
+    uint64_t old = slot[0].load(std::memory_order_relaxed);
+    bool sameKey = (uint32_t)old == (uint32_t)key.key
+        && (WORDS == 1 || (slot[1].load(std::memory_order_relaxed) ^ old) == high(key.key));
+    bool current = (old >> 60) == generation;
+    if (!sameKey && current && (int)((old >> 48) & 63) > depth) return;
+    if (key.mirrored && column >= 0) column = Board::COLS - 1 - column;
+    uint64_t data = pack((uint32_t)key.key, depth, score, bound, column, generation);
+    slot[0].store(data, std::memory_order_relaxed);
+    if (WORDS == 2) slot[1].store(high(key.key) ^ data, std::memory_order_relaxed);
+}
+
+template <class Board>
+void ConnectNTT<Board>::clear() {
+    for (size_t i = 0; i < slotCount * WORDS; ++i) slots[i].store(0, std::memory_order_relaxed);
+}
+
+template class ConnectNTT<ConnectFourBoard>;
+template class ConnectNTT<ConnectFour7x8Board>;
+#if CONNECTN_WIDE_BOARDS
+template class ConnectNTT<ConnectFour8x9Board>;
+template class ConnectNTT<ConnectFive8x9Board>;
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+#include "ChessTT.h" // TTBound
+#include "ConnectFourBoard.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+struct ConnectFourTTEntry {
+    int score = 0;   // 16-bit range
+    int depth = 0;   // remaining plies, 0..63
+    TTBound bound = TTBound::NONE;
+    int column = -1; // best move, or -1
+};
+
+// Compact, lock-free transposition table for Connect-N. A position and its left-right
+// mirror image share one entry: the key is the smaller of the two, and a best column stored
+// for the mirrored side is flipped on the way in and out.
+//
+// A slot's data word holds a 32-bit key check, 16-bit score, depth, bound, column and a 4-bit
+// search generation. The slot count is a prime of at least 2^17 and the index is key % count;
+// together with the low 32 key bits in the check that pins down the whole 49-bit key of the
+// standard board, so there a slot is that one word and never tears. Wider keys (7x8 and up)
+// get a second word with the key's bits above 32, stored xor the data word so a torn write
+// reads as a miss: a hit always matches the full key, as the exact solver needs.
+// Depths are capped at 63. The default 1 MB keeps the table in L2/L3.
+//
+// Replacement is depth-preferred with aging: an entry from an earlier search (newSearch())
+// is always replaced, within a search a shallower result never evicts a deeper one for a
+// different position, and the same position is always refreshed.
+template <class Board>
+class ConnectNTT {
+public:
+    using Bits = typename Board::Bits;
+    struct Key {
+        Bits key = 0;
+        bool mirrored = false; // key came from the mirror image
+    };
+    static Key keyOf(const Board& pos);
+
+    explicit ConnectNTT(size_t kilobytes = 1024);
+
+    bool probe(const Key& key, ConnectFourTTEntry& out) const;
+    void store(const Key& key, int depth, int score, TTBound bound, int column);
+    void newSearch() { generation = (generation + 1) & 15; }
+    void clear();
+    size_t size() const { return slotCount; }
+
+    // One word per slot suffices when the check and the index determine the key
+    static constexpr int WORDS = Board::H1 * Board::COLS <= 49 ? 1 : 2;
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    size_t slotCount = 0;
+    uint64_t generation = 1;
+
+    static uint64_t fold(Bits key);
+    static uint64_t high(Bits key) { return (uint64_t)(key >> 32); }
+    static uint64_t pack(uint32_t check, int depth, int score, TTBound bound, int column, uint64_t generation);
+};
+
+using ConnectFourTT = ConnectNTT<ConnectFourBoard>;
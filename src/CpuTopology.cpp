@@ -0,0 +1,152 @@
+#include "CpuTopology.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <thread>
+#include <utility>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__linux__)
+static bool readInt(const std::string& path, int& out) {
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f) return false;
+    bool ok = fscanf(f, "%d", &out) == 1;
+    fclose(f);
+    return ok;
+}
+
+// sysfs cpu lists: "0-3,8,10-11"
+static std::vector<int> readCpuList(const std::string& path) {
+    std::vector<int> cpus;
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f) return cpus;
+    int first, last;
+    char sep;
+    while (fscanf(f, "%d", &first) == 1) {
+        last = first;
+        if (fscanf(f, "%c", &sep) == 1 && sep == '-') {
+            if (fscanf(f, "%d", &last) != 1) break;
+            if (fscanf(f, "%c", &sep) != 1) sep = '\n';
+        }
+        for (int c = first; c <= last; ++c) cpus.push_back(c);
+        if (sep != ',') break;
+    }
+    fclose(f);
+    return cpus;
+}
+#endif
+
+CpuTopology::CpuTopology() {
+#if defined(__linux__)
+    const std::string base = "/sys/devices/system/";
+    std::vector<int> online = readCpuList(base + "cpu/online");
+    std::map<int, int> nodeOfCpu;
+    for (int node : readCpuList(base + "node/online")) {
+        for (int cpu : readCpuList(base + "node/node" + std::to_string(node) + "/cpulist")) nodeOfCpu[cpu] = node;
+    }
+
+    // Physical cores are (package, core_id) pairs; the first thread seen of each is primary
+    std::map<std::pair<int, int>, int> coreIds;
+    std::set<int> nodeSet;
+    for (int cpu : online) {
+        std::string topo = base + "cpu/cpu" + std::to_string(cpu) + "/topology/";
+        CpuInfo info;
+        info.cpu = cpu;
+        int coreId = cpu;
+        readInt(topo + "physical_package_id", info.package);
+        readInt(topo + "core_id", coreId);
+        auto key = std::make_pair(info.package, coreId);
+        auto it = coreIds.find(key);
+        info.primary = (it == coreIds.end());
+        if (info.primary) it = coreIds.emplace(key, (int)coreIds.size()).first;
+        info.core = it->second;
+        auto node = nodeOfCpu.find(cpu);
+        info.node = (node != nodeOfCpu.end()) ? node->second : 0;
+        nodeSet.insert(info.node);
+        list.push_back(info);
+    }
+    nodes = std::max<int>(1, (int)nodeSet.size());
+#endif
+    if (list.empty()) {
+        int count = std::max(1, (int)std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < count; ++cpu) list.push_back(CpuInfo{ cpu, cpu, 0, 0, true });
+    }
+}
+
+const CpuTopology& CpuTopology::system() {
+    static const CpuTopology topology;
+    return topology;
+}
+
+int CpuTopology::physicalCores() const {
+    return (int)std::count_if(list.begin(), list.end(), [](const CpuInfo& c) { return c.primary; });
+}
+
+int CpuTopology::nodeOf(int cpu) const {
+    for (const CpuInfo& c : list) {
+        if (c.cpu == cpu) return c.node;
+    }
+    return 0;
+}
+
+int CpuTopology::threadsFor(const ThreadPlacement& placement) const {
+    return placement.skipSMT ? physicalCores() : (int)list.size();
+}
+
+std::vector<int> CpuTopology::placement(int threads, bool skipSMT) const {
+    // Primary threads dealt round-robin across nodes, then (without skipSMT) the siblings likewise
+    std::vector<int> order;
+    for (bool primary : { true, false }) {
+        if (!primary && skipSMT) break;
+        std::map<int, std::vector<int>> byNode;
+        for (const CpuInfo& c : list) {
+            if (c.primary == primary) byNode[c.node].push_back(c.cpu);
+        }
+        for (size_t i = 0, added = 1; added; ++i) {
+            added = 0;
+            for (auto& node : byNode) {
+                if (i < node.second.size()) { order.push_back(node.second[i]); ++added; }
+            }
+        }
+    }
+
+    std::vector<int> cpus;
+    for (int t = 0; t < threads && !order.empty(); ++t) cpus.push_back(order[t % order.size()]);
+    return cpus;
+}
+
+std::string CpuTopology::describe() const {
+    char buf[96];
+    snprintf(buf, sizeof(buf), "%d node%s, %d cores, %d threads", nodes, nodes == 1 ? "" : "s", physicalCores(), (int)list.size());
+    return buf;
+}
+
+bool CpuTopology::pinCurrentThread(int cpu) {
+#if defined(_WIN32)
+    if (cpu < 0 || cpu >= (int)(8 * sizeof(DWORD_PTR))) return false;
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+void CpuTopology::placeWorker(int index, int threads, const ThreadPlacement& placement) {
+    if (!placement.pin) return;
+    std::vector<int> cpus = system().placement(threads, placement.skipSMT);
+    if (index >= 0 && index < (int)cpus.size()) pinCurrentThread(cpus[index]);
+}
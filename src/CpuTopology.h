@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// One logical CPU as seen by the OS
+struct CpuInfo {
+    int cpu = 0;
+    int core = 0;        // physical core, unique across packages
+    int package = 0;
+    int node = 0;        // NUMA node
+    bool primary = true; // lowest-numbered hardware thread of its core
+};
+
+// How a pool places its worker threads
+struct ThreadPlacement {
+    bool pin = false;    // bind each worker to its own CPU
+    bool skipSMT = true; // one worker per physical core, never on an SMT sibling
+};
+
+// Processor and NUMA layout, read once from Linux sysfs (/sys/devices/system/cpu and
+// /sys/devices/system/node). Elsewhere, or without sysfs, every hardware thread is its own
+// core on node 0 and pinning is a no-op.
+class CpuTopology {
+public:
+    static const CpuTopology& system();
+
+    const std::vector<CpuInfo>& cpus() const { return list; }
+    int nodeCount() const { return nodes; }
+    int physicalCores() const;
+    int nodeOf(int cpu) const;
+    // Default pool size: physical cores with skipSMT, else all hardware threads
+    int threadsFor(const ThreadPlacement& placement) const;
+    // CPU for each of `threads` workers: cores dealt round-robin across nodes so memory
+    // bandwidth is shared evenly, then SMT siblings unless skipped; wraps when threads exceed CPUs
+    std::vector<int> placement(int threads, bool skipSMT) const;
+    std::string describe() const; // "2 nodes, 32 cores, 64 threads"
+
+    static bool pinCurrentThread(int cpu);
+    // Pins worker `index` of a `threads`-sized pool; does nothing unless placement.pin is set
+    static void placeWorker(int index, int threads, const ThreadPlacement& placement);
+
+private:
+    CpuTopology();
+    std::vector<CpuInfo> list;
+    int nodes = 1;
+};
@@ -0,0 +1,57 @@
+#include "MappedFile.h"
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    HANDLE map = nullptr;
+    // Empty files cannot be mapped
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!map) { CloseHandle(file); return false; }
+    fileHandle = file;
+    mapHandle = map;
+    base = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    bytes = (size_t)fileSize.QuadPart;
+    if (!base) { close(); return false; }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    base = p;
+    bytes = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+#if defined(_WIN32)
+    if (base) UnmapViewOfFile(base);
+    if (mapHandle) CloseHandle((HANDLE)mapHandle);
+    if (fileHandle) CloseHandle((HANDLE)fileHandle);
+    mapHandle = fileHandle = nullptr;
+#else
+    if (base) munmap(base, bytes);
+#endif
+    base = nullptr;
+    bytes = 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file (mmap, or MapViewOfFile on Windows)
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+    const char* data() const { return (const char*)base; }
+    size_t size() const { return bytes; }
+
+private:
+    void* base = nullptr;
+    size_t bytes = 0;
+#if defined(_WIN32)
+    void* fileHandle = nullptr;
+    void* mapHandle = nullptr;
+#endif
+};
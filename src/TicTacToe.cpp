@@ -1,60 +1,7 @@
 #include "TicTacToe.h"
+#include "TicTacToeOracle.h"
 #include <algorithm>
 
-// --- Embedded simple AI (minimax with alpha-beta) for Tic-Tac-Toe ---
-static inline int tttScoreLine(char a, char b, char c) {
-    if (a == 'O' && b == 'O' && c == 'O') return 10;
-    if (a == 'X' && b == 'X' && c == 'X') return -10;
-    return 0;
-}
-static int tttEvaluate(const char b[9]) {
-    for (int r = 0; r < 3; ++r) {
-        int s = tttScoreLine(b[r * 3 + 0], b[r * 3 + 1], b[r * 3 + 2]);
-        if (s != 0) return s;
-    }
-    for (int c = 0; c < 3; ++c) {
-        int s = tttScoreLine(b[0 * 3 + c], b[1 * 3 + c], b[2 * 3 + c]);
-        if (s != 0) return s;
-    }
-    {
-        int s = tttScoreLine(b[0], b[4], b[8]);
-        if (s != 0) return s;
-    }
-    {
-        int s = tttScoreLine(b[2], b[4], b[6]);
-        if (s != 0) return s;
-    }
-    return 0;
-}
-static bool tttMovesLeft(const char b[9]) {
-    for (int i = 0; i < 9; ++i) if (b[i] == ' ') return true; return false;
-}
-static int tttMinimax(char b[9], int depth, bool isMax, int alpha, int beta) {
-    int score = tttEvaluate(b);
-    if (score == 10) return score - depth;
-    if (score == -10) return score + depth;
-    if (!tttMovesLeft(b)) return 0;
-    if (isMax) {
-        int best = -1000;
-        for (int i = 0; i < 9; ++i) if (b[i] == ' ') { b[i] = 'O'; int v = tttMinimax(b, depth + 1, false, alpha, beta); b[i] = ' '; best = std::max(best, v); alpha = std::max(alpha, best); if (beta <= alpha) break; }
-        return best;
-    }
-    else {
-        int best = 1000;
-        for (int i = 0; i < 9; ++i) if (b[i] == ' ') { b[i] = 'X'; int v = tttMinimax(b, depth + 1, true, alpha, beta); b[i] = ' '; best = std::min(best, v); beta = std::min(beta, best); if (beta <= alpha) break; }
-        return best;
-    }
-}
-static int tttBestMove(const char board[9]) {
-    char b[9]; for (int i = 0; i < 9; ++i) b[i] = board[i];
-    int bestVal = -1000, bestMove = -1;
-    for (int i = 0; i < 9; ++i) if (b[i] == ' ') {
-        b[i] = 'O'; int val = tttMinimax(b, 0, false, -10000, 10000); b[i] = ' ';
-        if (val > bestVal) { bestVal = val; bestMove = i; }
-    }
-    return bestMove;
-}
-
 void TicTacToeGame::init(int screenWidth, int screenHeight) {
     reset();
     const float margin = 50.0f;
@@ -170,10 +117,10 @@ void TicTacToeGame::aiTurn() {
         return;
     }
 
-    // Hard: perfect play via minimax
+    // Hard: perfect play, looked up in the solved table
     char flat[9];
     for (int r = 0; r < 3; ++r) for (int c = 0; c < 3; ++c) flat[r * 3 + c] = board[r][c];
-    int idx = tttBestMove(flat);
+    int idx = TicTacToeOracle::bestMove(flat);
     if (idx >= 0) { int r = idx / 3; int c = idx % 3; makeMove(r, c, 'O'); }
 }
 
@@ -0,0 +1,144 @@
+#include "TicTacToeOracle.h"
+
+namespace TicTacToeOracle {
+namespace {
+
+constexpr int LINES[8][3] = { {0,1,2}, {3,4,5}, {6,7,8}, {0,3,6}, {1,4,7}, {2,5,8}, {0,4,8}, {2,4,6} };
+
+// The eight symmetries of the board as cell maps: cell i of the image is cell perm[t][i]
+struct Symmetries {
+    int perm[8][9];
+};
+
+constexpr Symmetries makeSymmetries() {
+    Symmetries s{};
+    for (int t = 0; t < 8; ++t) {
+        for (int i = 0; i < 9; ++i) {
+            int r = i / 3, c = i % 3;
+            if (t & 4) c = 2 - c;
+            for (int k = 0; k < (t & 3); ++k) { int turned = 2 - r; r = c; c = turned; }
+            s.perm[t][i] = r * 3 + c;
+        }
+    }
+    return s;
+}
+
+struct Table {
+    Entry entries[STATES];
+    int reachable = 0;
+    int classes = 0;
+};
+
+constexpr void decode(int code, int cell[9]) {
+    for (int i = 0; i < 9; ++i, code /= 3) cell[i] = code % 3;
+}
+
+// Bit 0 if X has a line, bit 1 if O has
+constexpr int lineOwners(const int cell[9]) {
+    int owners = 0;
+    for (const auto& line : LINES) {
+        if (cell[line[0]] && cell[line[0]] == cell[line[1]] && cell[line[1]] == cell[line[2]]) owners |= cell[line[0]];
+    }
+    return owners;
+}
+
+// One ply further from the end: wins and losses lose a point of urgency, draws stay 0
+constexpr int older(int value) { return value > 0 ? value - 1 : value < 0 ? value + 1 : 0; }
+
+// Retrograde solve. The positions reachable from the empty board are listed layer by layer
+// (by stones played), then valued from the full layer back to the empty one: the first board
+// of each symmetry class met is searched, and its images take the same value. Moves are picked
+// per board from the children's values, so the tie-break is the plain lowest cell.
+constexpr Table solve() {
+    Table t{};
+    constexpr Symmetries sym = makeSymmetries();
+    int pow3[9] = { 1 };
+    for (int i = 1; i < 9; ++i) pow3[i] = pow3[i - 1] * 3;
+
+    short list[STATES] = {}, searched[STATES] = {}; // searched[code]: 1 + the board valued for its class
+    uint8_t owners[STATES] = {};
+    int layer[11] = { 0, 1 }, size = 1;
+    t.entries[0].reachable = true;
+    for (int n = 0; n < 9; ++n) {
+        int piece = (n & 1) ? 2 : 1; // X moves on even layers
+        for (int k = layer[n]; k < layer[n + 1]; ++k) {
+            int code = list[k];
+            if (owners[code]) continue;
+            for (int i = 0; i < 9; ++i) {
+                int child = code + pow3[i] * piece;
+                if ((code / pow3[i]) % 3 || t.entries[child].reachable) continue;
+                int cell[9] = {};
+                decode(child, cell);
+                t.entries[child].reachable = true;
+                owners[child] = (uint8_t)lineOwners(cell);
+                list[size++] = (short)child;
+            }
+        }
+        layer[n + 2] = size;
+    }
+    t.reachable = size;
+
+    for (int n = 9; n >= 0; --n) {
+        int piece = (n & 1) ? 2 : 1;
+        for (int k = layer[n]; k < layer[n + 1]; ++k) {
+            int code = list[k], cell[9] = {};
+            if (searched[code]) continue;
+            decode(code, cell);
+            for (const auto& perm : sym.perm) {
+                int image = 0;
+                for (int i = 8; i >= 0; --i) image = image * 3 + cell[perm[i]];
+                searched[image] = (short)(code + 1);
+            }
+            ++t.classes;
+            Entry& e = t.entries[code];
+            if (owners[code]) { e.value = (int8_t)(owners[code] == 2 ? 10 : -10); continue; }
+            if (n == 9) continue;
+            int best = piece == 1 ? 100 : -100;
+            for (int i = 0; i < 9; ++i) {
+                if (cell[i]) continue;
+                int v = older(t.entries[code + pow3[i] * piece].value);
+                if (piece == 1 ? v < best : v > best) best = v;
+            }
+            e.value = (int8_t)best;
+        }
+        for (int k = layer[n]; k < layer[n + 1]; ++k) t.entries[list[k]].value = t.entries[searched[list[k]] - 1].value;
+    }
+
+    for (int n = 0; n < 9; ++n) {
+        int piece = (n & 1) ? 2 : 1;
+        for (int k = layer[n]; k < layer[n + 1]; ++k) {
+            int code = list[k];
+            if (owners[code]) continue;
+            Entry& e = t.entries[code];
+            int best = piece == 1 ? 100 : -100;
+            for (int i = 0; i < 9; ++i) {
+                if ((code / pow3[i]) % 3) continue;
+                int v = t.entries[code + pow3[i] * piece].value;
+                if (piece == 1 ? v < best : v > best) { best = v; e.move = (int8_t)i; }
+            }
+        }
+    }
+    return t;
+}
+
+constexpr Table kTable = solve();
+
+static_assert(kTable.reachable == 5478 && kTable.classes == 765, "positions reachable in play, and their symmetry classes");
+static_assert(kTable.entries[0].value == 0, "the empty board is a draw");
+static_assert(kTable.entries[1].move == 4, "after X takes a corner, only the center holds the draw");
+
+}
+
+const Entry& lookup(int code) {
+    static const Entry none{};
+    return code >= 0 && code < STATES ? kTable.entries[code] : none;
+}
+
+void bestMoves(const char* boards, int count, int* moves) {
+    for (int b = 0; b < count; ++b) moves[b] = kTable.entries[encode(boards + 9 * b)].move;
+}
+
+int reachableCount() { return kTable.reachable; }
+int classCount() { return kTable.classes; }
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+
+// Perfect play for Tic-Tac-Toe, solved at compile time (TicTacToeOracle.cpp) into a table over
+// every board of 3^9 cells, so a move is one lookup. Boards are 9 chars, ' ', 'X' or 'O', cell
+// = row * 3 + col; X moves first, so the side to move follows from the counts.
+namespace TicTacToeOracle {
+
+constexpr int STATES = 19683; // 3^9
+
+struct Entry {
+    int8_t value = 0;   // with best play, from O's side: 10 - plies until O wins, -10 + plies until X wins, 0 a draw
+    int8_t move = -1;   // best cell for the side to move, the lowest among equals; -1 once over, or if unreachable
+    bool reachable = false;
+};
+
+// Base-3 code: cell i adds 3^i times 0 (empty), 1 (X) or 2 (O)
+constexpr int encode(const char board[9]) {
+    int code = 0;
+    for (int i = 8; i >= 0; --i) code = code * 3 + (board[i] == 'X' ? 1 : board[i] == 'O' ? 2 : 0);
+    return code;
+}
+
+const Entry& lookup(int code);
+inline const Entry& lookup(const char board[9]) { return lookup(encode(board)); }
+inline int bestMove(const char board[9]) { return lookup(encode(board)).move; }
+// bestMove() for `count` boards stored back to back, 9 chars each
+void bestMoves(const char* boards, int count, int* moves);
+
+int reachableCount();   // positions that occur in play: 5478
+int classCount();       // the same up to rotation and reflection: 765
+
+}
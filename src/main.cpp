@@ -4,12 +4,23 @@
 #include "TicTacToe.h"
 #include "ConnectFour.h"
 #include "Chess.h"
+#include "ChessAnalysis.h"
+#include "ChessReview.h"
 #include "globals.h"
+#include "Bench.h"
+#include "ChessPerft.h"
+#include "ChessPgn.h"
+#include "ChessCluster.h"
+#include "ConnectFourBook.h"
+#include <cstring>
 
 // Define the global difficulty variable (default Hard)
 GameDifficulty currentDifficulty = HARD;
 
-static void RunGameLoop() {
+static const char* kChessCachePath = "chess_search.cache";
+static const char* kConnectFourBookPath = "connect4_opening.book";
+
+static void RunGameLoop(ConnectFourEngine c4Engine) {
     const int screenWidth = 800;
     const int screenHeight = 720;
     InitWindow(screenWidth, screenHeight, "Strategic Game Mastery");
@@ -20,8 +31,20 @@ static void RunGameLoop() {
     GameState state = GameState::STATE_MENU;
     Menu menu; menu.init(screenWidth, screenHeight); menu.setFont(uiFont);
     TicTacToeGame ttt; ttt.init(screenWidth, screenHeight); ttt.setFont(uiFont);
-    ConnectFourGame c4; c4.init(screenWidth, screenHeight); c4.setFont(uiFont);
-    ChessGame chess; chess.init(screenWidth, screenHeight); chess.setFont(uiFont);
+    ConnectFourGame c4; c4.init(screenWidth, screenHeight); c4.setFont(uiFont); c4.setEngine(c4Engine);
+    c4.loadOpeningBook(kConnectFourBookPath); // optional; build with --c4book
+    // On NUMA machines the chess workers are pinned, matching the node-interleaved search table:
+    // the review pool takes every core but one and the analyzer the one left, so they never share
+    ThreadPlacement chessPlacement;
+    ReviewOptions reviewOptions;
+    int cores = CpuTopology::system().threadsFor(chessPlacement);
+    chessPlacement.pin = CpuTopology::system().nodeCount() > 1 && cores > 1;
+    reviewOptions.placement = chessPlacement;
+    if (chessPlacement.pin) reviewOptions.threads = cores - 1;
+    ChessAnalyzer chessAnalyzer(3, chessPlacement, reviewOptions.threads);
+    GameReviewer chessReviewer(reviewOptions);
+    ChessGame chess; chess.init(screenWidth, screenHeight); chess.setFont(uiFont); chess.setAnalyzer(&chessAnalyzer); chess.setReviewer(&chessReviewer);
+    chess.loadSearchCache(kChessCachePath);
 
     while (!WindowShouldClose()) {
         // Update
@@ -44,12 +67,23 @@ static void RunGameLoop() {
         EndDrawing();
     }
 
+    // The analyzer and reviewer share the table, so they must be idle before the cache file is rewritten
+    chessAnalyzer.shutdown();
+    chessReviewer.cancel();
+    chess.saveSearchCache(kChessCachePath);
+
     UnloadFont(uiFont);
     CloseWindow();
 }
 
 // Standard console entry (useful for console builds)
-int main() {
-    RunGameLoop();
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) return RunBenchmarks(argc - 2, argv + 2);
+    if (argc > 1 && strncmp(argv[1], "--perft", 7) == 0) return RunPerftTool(argc - 1, argv + 1);
+    if (argc > 1 && strncmp(argv[1], "--pgn-", 6) == 0) return RunPgnTool(argc - 1, argv + 1);
+    if (argc > 1 && strncmp(argv[1], "--cluster", 9) == 0) return RunClusterTool(argc - 1, argv + 1);
+    if (argc > 1 && strcmp(argv[1], "--c4book") == 0) return RunConnectFourBookTool(argc - 1, argv + 1);
+    // --c4-mcts: Monte Carlo tree search instead of alpha-beta for the Connect Four AI
+    RunGameLoop(argc > 1 && strcmp(argv[1], "--c4-mcts") == 0 ? ConnectFourEngine::MCTS : ConnectFourEngine::ALPHA_BETA);
     return 0;
 }
\ No newline at end of file